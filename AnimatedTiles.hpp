@@ -0,0 +1,111 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "Level.hpp"
+
+namespace worldlib
+{
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file AnimatedTiles.hpp
+/// \brief Contains functions for playing back a level's animated tiles.
+///
+/// \addtogroup Level
+///  @{
+//////////////////////////////////////////////////////////////////////////////
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief Every animation frame of a level's AN2 file, ready to be copied into a VRAM image made by composeLevelVRAM.
+	/// \details The AN2 file is decompressed (and expanded to 4bpp if needed) once, when this is created.  The file is treated as a list of frames stored one after another, each tilesPerFrame 8x8 tiles long.
+	/// Every frame is kept in VRAM format, so showing one is just a copy of its bytes over the destination in VRAM.
+	/// A partial frame at the end of the file is padded with 0s.
+	////////////////////////////////////////////////////////////
+	class AnimatedTileFrames
+	{
+	public:
+
+		////////////////////////////////////////////////////////////
+		/// \brief The size of one 4bpp tile in bytes
+		////////////////////////////////////////////////////////////
+		static const int bytesPerTile = 32;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Creates an empty set with no frames
+		////////////////////////////////////////////////////////////
+		AnimatedTileFrames();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Decodes the specified level's AN2 file and splits it into frames.
+		/// \details Like composeLevelVRAM, a file that's exactly 0xC00 bytes is 3bpp and is expanded to 4bpp.
+		///
+		/// Each frame replaces the tiles it's copied over.  Tile number n of composeLevelVRAM's buffer (the number Map16 tiles use) starts at byte n * 32, so a frame copied to
+		/// vramOffset replaces tiles vramOffset / 32 to vramOffset / 32 + tilesPerFrame - 1.  Only tiles 000 - 2FF (FG1 - BG3) are drawn by Map16BlockCache, so that's where
+		/// animations meant to show up in a preview should go, e.g. 0x0600 for tiles 030 - 037.
+		///
+		/// \param romStart		An iterator pointing to the beginning of the ROM data
+		/// \param romEnd		An iterator pointing to the end of the ROM data
+		/// \param level		The level to get the animated tiles of
+		/// \param tilesPerFrame	How many 8x8 tiles each frame is
+		/// \param vramOffset		Where in the composed VRAM each frame gets copied to, in bytes (the first tile replaced times 32)
+		///
+		/// \throws std::runtime_error If the level has no AN2 file (its slot is 0x7F), if the file couldn't be decompressed (see decompressGraphicsFile), if tilesPerFrame is invalid, if a frame wouldn't fit in VRAM at vramOffset, or if the ROM did not contain this data
+		///
+		////////////////////////////////////////////////////////////
+		template <typename inputIteratorType>
+		AnimatedTileFrames(inputIteratorType romStart, inputIteratorType romEnd, int level, int tilesPerFrame, int vramOffset);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns how many frames there are
+		////////////////////////////////////////////////////////////
+		int getFrameCount() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns how many 8x8 tiles each frame is
+		////////////////////////////////////////////////////////////
+		int getTilesPerFrame() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the size of each frame in bytes
+		////////////////////////////////////////////////////////////
+		int getFrameSize() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns where in VRAM the frames get copied to
+		////////////////////////////////////////////////////////////
+		int getVRAMOffset() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the 4bpp tile data of the specified frame (getFrameSize bytes)
+		///
+		/// \throws std::runtime_error If the frame is out of range
+		///
+		////////////////////////////////////////////////////////////
+		const std::uint8_t *getFrame(int frame) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Copies the specified frame over its spot in a VRAM image made by composeLevelVRAM.
+		///
+		/// \param frame		The frame to show.  Wraps around, so you can just pass a frame counter.
+		/// \param vram			A random access iterator to the start of the VRAM image (at least 0xB000 bytes)
+		///
+		/// \throws std::runtime_error If there are no frames
+		///
+		////////////////////////////////////////////////////////////
+		template <typename randomAccessIteratorType>
+		void applyFrame(int frame, randomAccessIteratorType vram) const;
+
+	protected:
+		int tilesPerFrame;
+		int frameCount;
+		int vramOffset;
+		std::vector<std::uint8_t> frames;
+	};
+
+
+//////////////////////////////////////////////////////////////////////////////
+///  @}
+//////////////////////////////////////////////////////////////////////////////
+}
+
+#include "AnimatedTiles.inl"
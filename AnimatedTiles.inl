@@ -0,0 +1,82 @@
+#include "Internal.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <iterator>
+
+namespace worldlib
+{
+	inline AnimatedTileFrames::AnimatedTileFrames() : tilesPerFrame(0), frameCount(0), vramOffset(0)
+	{
+	}
+
+	template <typename inputIteratorType>
+	AnimatedTileFrames::AnimatedTileFrames(inputIteratorType romStart, inputIteratorType romEnd, int level, int tilesPerFrame, int vramOffset) : tilesPerFrame(tilesPerFrame), frameCount(0), vramOffset(vramOffset)
+	{
+		if (tilesPerFrame <= 0)
+			throw std::runtime_error("An animation frame must be at least one tile.");
+		if (vramOffset < 0 || vramOffset + tilesPerFrame * bytesPerTile > internal::levelVRAMSize)
+			throw std::runtime_error("Animation frames would not fit in VRAM at that offset.");
+
+		int file = getLevelAnimatedTileAreaGraphicsSlot(romStart, romEnd, level);
+		if (file == 0x7F)
+			throw std::runtime_error("Level has no animated tile file.");
+
+		frames.clear();
+		decompressGraphicsFile(romStart, romEnd, std::back_inserter(frames), file);
+
+		int tileCount;
+		if ((int)frames.size() == internal::levelVRAMSlotSize / 4 * 3)			// 0xC00 bytes is a 3bpp file, the same as in composeLevelVRAM
+		{
+			tileCount = (int)frames.size() / 24;
+			frames.resize(tileCount * bytesPerTile);
+			internal::expand3bppTo4bpp(frames.begin(), tileCount);
+		}
+		else
+		{
+			tileCount = ((int)frames.size() + bytesPerTile - 1) / bytesPerTile;
+		}
+
+		frameCount = (tileCount + tilesPerFrame - 1) / tilesPerFrame;
+		frames.resize(frameCount * getFrameSize(), 0);
+	}
+
+	inline int AnimatedTileFrames::getFrameCount() const
+	{
+		return frameCount;
+	}
+
+	inline int AnimatedTileFrames::getTilesPerFrame() const
+	{
+		return tilesPerFrame;
+	}
+
+	inline int AnimatedTileFrames::getFrameSize() const
+	{
+		return tilesPerFrame * bytesPerTile;
+	}
+
+	inline int AnimatedTileFrames::getVRAMOffset() const
+	{
+		return vramOffset;
+	}
+
+	inline const std::uint8_t *AnimatedTileFrames::getFrame(int frame) const
+	{
+		if (frame < 0 || frame >= frameCount)
+			throw std::runtime_error("Animation frame is out of range.");
+		return frames.data() + frame * getFrameSize();
+	}
+
+	template <typename randomAccessIteratorType>
+	void AnimatedTileFrames::applyFrame(int frame, randomAccessIteratorType vram) const
+	{
+		if (frameCount == 0)
+			throw std::runtime_error("There are no animation frames.");
+
+		frame %= frameCount;
+		if (frame < 0) frame += frameCount;
+
+		const std::uint8_t *source = getFrame(frame);
+		std::copy(source, source + getFrameSize(), vram + vramOffset);
+	}
+}
@@ -1,6 +1,23 @@
 #pragma once
 #include <iterator>
 #include <cstdint>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <cstddef>
+
+// The bulk swizzler checks which byte shuffles (PSHUFB) the CPU it's running on has, so it uses them even when the compiler isn't targeting SSSE3 or AVX2 (like MSVC's default settings).
+// Define WORLDLIB_NO_SIMD to always use the plain version.  These macros are only for this file and are undefined at the end of it.
+#if !defined(WORLDLIB_NO_SIMD) && (defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__))
+#define WORLDLIB_SWIZZLE_SIMD
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define WORLDLIB_SWIZZLE_TARGET(instructions)						// MSVC emits any intrinsic without being asked to.
+#else
+#define WORLDLIB_SWIZZLE_TARGET(instructions) __attribute__((target(instructions)))
+#endif
+#endif
 
 //////////////////////////////////////////////////////////////////////////////
 /// \file ColorBackInserter.hpp
@@ -122,6 +139,254 @@ namespace worldlib
 		return (ColorBackInserterIterator<containerType>(container, order));
 	}
 
+	namespace internal
+	{
+		////////////////////////////////////////////////////////////
+		/// \brief Rearranges an ARGB color into the order given.  Since the order is known at compile time every shift is a constant, so this ends up as a byte swap, a rotate, or a couple of masks.
+		////////////////////////////////////////////////////////////
+		template<ColorOrder order>
+		inline std::uint32_t swizzleColor(std::uint32_t value)
+		{
+			// Which byte of the ARGB value (counting from the top) ends up in each slot.
+			enum : int
+			{
+				slot1Shift = 24 - (((int)order & 0xC0) >> 6) * 8,
+				slot2Shift = 24 - (((int)order & 0x30) >> 4) * 8,
+				slot3Shift = 24 - (((int)order & 0x0C) >> 2) * 8,
+				slot4Shift = 24 - (((int)order & 0x03) >> 0) * 8
+			};
+
+			return (((value >> slot1Shift) & 0xFF) << 24) | (((value >> slot2Shift) & 0xFF) << 16) | (((value >> slot3Shift) & 0xFF) << 8) | (((value >> slot4Shift) & 0xFF) << 0);
+		}
+	}
+
+	////////////////////////////////////////////////////////////
+	/// \brief Same as ColorBackInserterIterator, but the color order is a template parameter instead of something checked for every color.
+	/// \details Both the rearranging of the color and the choice between splitting it into 4 bytes or inserting it as one 32-bit value are decided at compile time, so this is the one to use when exporting large bitmaps.
+	////////////////////////////////////////////////////////////
+	template<ColorOrder order, class ContainerType>
+	class StaticColorBackInserterIterator : std::iterator<std::output_iterator_tag, void, void, void, void>
+	{
+	protected:
+		////////////////////////////////////////////////////////////
+		/// \brief The container this iterator belongs to
+		////////////////////////////////////////////////////////////
+		ContainerType *myContainer;
+
+	public:
+
+		////////////////////////////////////////////////////////////
+		/// \brief The data type this iterator points to
+		////////////////////////////////////////////////////////////
+		typedef typename ContainerType::value_type typePointedTo;
+
+		////////////////////////////////////////////////////////////
+		/// \brief True if the container holds 8-bit data and colors need to be split into individual bytes
+		////////////////////////////////////////////////////////////
+		typedef std::integral_constant<bool, std::numeric_limits<typePointedTo>::max() - std::numeric_limits<typePointedTo>::min() == std::numeric_limits<std::uint8_t>::max()> containerIsByteSized;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Creates a StaticColorBackInserterIterator from the specified container.
+		///
+		/// \param otherContainer	The container to insert into
+		///
+		////////////////////////////////////////////////////////////
+		explicit StaticColorBackInserterIterator(ContainerType& otherContainer) : myContainer(std::addressof(otherContainer)) { }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Inserts the color into the iterator's container.
+		/// \details Works exactly like ColorBackInserterIterator::operator=.
+		///
+		/// \param value ARGB color value to insert.
+		///
+		/// \return The current structure (*this)
+		///
+		////////////////////////////////////////////////////////////
+		StaticColorBackInserterIterator<order, ContainerType> &operator=(std::uint32_t value)
+		{
+			insert(internal::swizzleColor<order>(value), containerIsByteSized());
+			return *this;
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Does nothing.  As with a normal std::back_insert_iterator, simply exists to satisfy the requirements of an iterator.
+		////////////////////////////////////////////////////////////
+		StaticColorBackInserterIterator<order, ContainerType> &operator*() { return (*this); }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Does nothing.  As with a normal std::back_insert_iterator, simply exists to satisfy the requirements of an iterator.
+		////////////////////////////////////////////////////////////
+		StaticColorBackInserterIterator<order, ContainerType> &operator++(){ return (*this); }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Does nothing.  As with a normal std::back_insert_iterator, simply exists to satisfy the requirements of an iterator.
+		////////////////////////////////////////////////////////////
+		StaticColorBackInserterIterator<order, ContainerType> operator++(int) { return (*this); }
+
+	private:
+		void insert(std::uint32_t swizzled, std::true_type)
+		{
+			myContainer->push_back(static_cast<typePointedTo>((swizzled >> 24) & 0xFF));
+			myContainer->push_back(static_cast<typePointedTo>((swizzled >> 16) & 0xFF));
+			myContainer->push_back(static_cast<typePointedTo>((swizzled >> 8) & 0xFF));
+			myContainer->push_back(static_cast<typePointedTo>((swizzled >> 0) & 0xFF));
+		}
+
+		void insert(std::uint32_t swizzled, std::false_type)
+		{
+			myContainer->push_back(static_cast<typePointedTo>(swizzled));
+		}
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \relates StaticColorBackInserterIterator
+	/// \brief Returns a StaticColorBackInserterIterator.  Use it like ColorBackInserter, but with the order as a template parameter:  ColorBackInserter<ColorOrder::RGBA>(container)
+	///
+	/// \param container		The container to insert into.  For example, a std::vector<unsigned char> or a std::vector<std::uint32_t>.
+	///
+	////////////////////////////////////////////////////////////
+	template<ColorOrder order, class containerType>
+	inline StaticColorBackInserterIterator<order, containerType> ColorBackInserter(containerType &container)
+	{
+		return (StaticColorBackInserterIterator<order, containerType>(container));
+	}
+
+	////////////////////////////////////////////////////////////
+	/// \relates ColorBackInserterIterator
+	/// \brief Returns a ColorBackInserterIterator after reserving enough room in the container for the number of colors you're about to insert.
+	/// \details Use this when you already know how big the image is (i.e. width * height), so the container only gets resized once instead of over and over while the image is being written.
+	///
+	/// \param container		The container to insert into.  For example, a std::vector<unsigned char> or a std::vector<std::uint32_t>.
+	/// \param order		The order to insert into.  For example, ColorOrder::ARGB.
+	/// \param colorCount		How many colors will be inserted.  For 8-bit containers, 4 times this many elements are reserved.
+	///
+	////////////////////////////////////////////////////////////
+	template<class containerType>
+	inline ColorBackInserterIterator<containerType> ReservingColorBackInserter(containerType &container, ColorOrder order, std::size_t colorCount)
+	{
+		typedef typename containerType::value_type valueType;
+		std::size_t elementsPerColor = (std::numeric_limits<valueType>::max() - std::numeric_limits<valueType>::min() == std::numeric_limits<std::uint8_t>::max()) ? 4 : 1;
+		container.reserve(container.size() + colorCount * elementsPerColor);
+		return (ColorBackInserterIterator<containerType>(container, order));
+	}
+
+	namespace internal
+	{
+		// Fills mask with the PSHUFB control bytes for 4 colors in the given order.  Colors in memory are little-endian ARGB, so A is byte 3 and B is byte 0 of each one.
+		inline void getColorShuffleMask(ColorOrder order, std::uint8_t mask[16])
+		{
+			int shifts[4] = { 6, 4, 2, 0 };
+			for (int color = 0; color < 4; color++)
+				for (int slot = 0; slot < 4; slot++)
+					mask[color * 4 + slot] = static_cast<std::uint8_t>(color * 4 + 3 - (((int)order >> shifts[slot]) & 0x03));
+		}
+
+		// The widest shuffle swizzleColors can use on this CPU
+		enum class SwizzleInstructionSet : int
+		{
+			Plain = 0,
+			SSSE3 = 1,
+			AVX2 = 2
+		};
+
+		// Asks the CPU which shuffles it has.  CPUID is slow (and traps to the hypervisor in a VM), so use getSwizzleInstructionSet instead, which only does this once.
+		inline SwizzleInstructionSet detectSwizzleInstructionSet()
+		{
+#ifdef WORLDLIB_SWIZZLE_SIMD
+#ifdef _MSC_VER
+			int info[4];
+			__cpuid(info, 0);
+			int highestLeaf = info[0];
+			__cpuid(info, 1);
+			bool ssse3 = (info[2] & (1 << 9)) != 0;
+			bool osSavesAVX = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;		// OSXSAVE and AVX, and the OS saves the YMM registers
+			bool avx2 = false;
+			if (highestLeaf >= 7 && osSavesAVX)
+			{
+				__cpuidex(info, 7, 0);
+				avx2 = (info[1] & (1 << 5)) != 0;
+			}
+#else
+			__builtin_cpu_init();
+			bool ssse3 = __builtin_cpu_supports("ssse3") != 0;
+			bool avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+			if (avx2) return SwizzleInstructionSet::AVX2;
+			if (ssse3) return SwizzleInstructionSet::SSSE3;
+#endif
+			return SwizzleInstructionSet::Plain;
+		}
+
+		inline SwizzleInstructionSet getSwizzleInstructionSet()
+		{
+			// VS2013 doesn't make static initialization thread-safe, but a thread that reads this before it's set just sees Plain (0) and uses the scalar version that once.
+			static const SwizzleInstructionSet instructionSet = detectSwizzleInstructionSet();
+			return instructionSet;
+		}
+
+#ifdef WORLDLIB_SWIZZLE_SIMD
+		// Each of these swizzles as many whole groups of colors as it can and returns how many it did.
+		WORLDLIB_SWIZZLE_TARGET("ssse3") inline std::size_t swizzleColorsSSSE3(const std::uint32_t *argb, std::size_t n, const std::uint8_t mask[16], std::uint8_t *out)
+		{
+			std::size_t i = 0;
+			__m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mask));
+			for (; i + 4 <= n; i += 4)
+			{
+				__m128i colors = _mm_loadu_si128(reinterpret_cast<const __m128i *>(argb + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i * 4), _mm_shuffle_epi8(colors, shuffle));
+			}
+			return i;
+		}
+
+		WORLDLIB_SWIZZLE_TARGET("avx2") inline std::size_t swizzleColorsAVX2(const std::uint32_t *argb, std::size_t n, const std::uint8_t mask[16], std::uint8_t *out)
+		{
+			std::size_t i = 0;
+			__m256i wideShuffle = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(mask)));
+			for (; i + 8 <= n; i += 8)
+			{
+				__m256i colors = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(argb + i));
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i * 4), _mm256_shuffle_epi8(colors, wideShuffle));
+			}
+			return i;
+		}
+#endif
+	}
+
+	////////////////////////////////////////////////////////////
+	/// \relates ColorBackInserterIterator
+	/// \brief Rearranges a whole buffer of ARGB colors at once and writes them as bytes, the same way ColorBackInserterIterator does for 8-bit containers.
+	/// \details Uses a single byte shuffle per 4 colors (or 8 with AVX2) when the CPU has SSSE3 or AVX2, so it works for every ColorOrder, including ones that repeat a channel like AAAA.
+	/// Which one to use is checked when it's called, so it doesn't depend on what the compiler was told to target.
+	/// out must already have room for n * 4 bytes.
+	///
+	/// \param argb		Pointer to the colors to convert
+	/// \param n			How many colors to convert
+	/// \param order		The order to write each color's bytes in.  For example, ColorOrder::RGBA.
+	/// \param out			Where to write the n * 4 resulting bytes
+	///
+	////////////////////////////////////////////////////////////
+	inline void swizzleColors(const std::uint32_t *argb, std::size_t n, ColorOrder order, std::uint8_t *out)
+	{
+		std::uint8_t mask[16];
+		internal::getColorShuffleMask(order, mask);
+		std::size_t i = 0;
+
+#ifdef WORLDLIB_SWIZZLE_SIMD
+		auto instructionSet = internal::getSwizzleInstructionSet();
+		if (instructionSet == internal::SwizzleInstructionSet::AVX2)
+			i += internal::swizzleColorsAVX2(argb, n, mask, out);
+		if (instructionSet != internal::SwizzleInstructionSet::Plain)
+			i += internal::swizzleColorsSSSE3(argb + i, n - i, mask, out + i * 4);
+#endif
+
+		for (; i < n; i++)
+		{
+			std::uint32_t value = argb[i];
+			for (int slot = 0; slot < 4; slot++)
+				out[i * 4 + slot] = static_cast<std::uint8_t>(value >> (mask[slot] * 8));
+		}
+	}
+
 	////////////////////////////////////////////////////////////
 	/// \relates ColorBackInserterIterator
 	/// \brief The order colors are stored in a ColorBackInsertIterator.
@@ -394,4 +659,7 @@ namespace worldlib
 
 //////////////////////////////////////////////////////////////////////////////
 ///  @}
-//////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
+//////////////////////////////////////////////////////////////////////////////
+
+#undef WORLDLIB_SWIZZLE_SIMD
+#undef WORLDLIB_SWIZZLE_TARGET
@@ -0,0 +1,170 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "ColorBackInserter.hpp"
+
+// The compositor compares and selects whole groups of pixels at once with SSE2 (always there on x64) or AVX2 if the compiler is allowed to emit it.  Define WORLDLIB_NO_SIMD to always use the plain version.
+// These macros are only for this file and Compositor.inl, and are undefined at the end of this file.
+#ifndef WORLDLIB_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WORLDLIB_COMPOSITOR_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define WORLDLIB_COMPOSITOR_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+namespace worldlib
+{
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file Compositor.hpp
+/// \brief Contains functions for combining drawn layers into a final frame like the SNES does.
+///
+/// \addtogroup Level
+///  @{
+//////////////////////////////////////////////////////////////////////////////
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief The SNES layers SMW draws with
+	////////////////////////////////////////////////////////////
+	enum class ScreenLayer : int
+	{
+		BG1 = 0,		///< Layer 1
+		BG2 = 1,		///< Layer 2
+		BG3 = 2,		///< Layer 3
+		Sprites = 3,		///< Sprites (OBJ)
+		Backdrop = 4		///< The background color.  Only ever reported by composeLayers, not passed in.
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief The ways the SNES can combine the main screen with the sub screen (or fixed color)
+	////////////////////////////////////////////////////////////
+	enum class ColorMathMode : int
+	{
+		Add = 0,		///< main + sub, each channel capped at 31
+		AddHalf = 1,		///< (main + sub) / 2
+		Subtract = 2,		///< main - sub, each channel floored at 0
+		SubtractHalf = 3	///< (main - sub) / 2, floored at 0
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief One drawn layer to pass to composeLayers.  Make these with makeCompositorLayer or makeIndexedCompositorLayer.
+	////////////////////////////////////////////////////////////
+	struct CompositorLayer
+	{
+		////////////////////////////////////////////////////////////
+		/// \brief Which layer this is
+		////////////////////////////////////////////////////////////
+		ScreenLayer layer;
+
+		////////////////////////////////////////////////////////////
+		/// \brief ARGB color of each pixel, where an alpha of 0 is transparent (like indexedImageToBitmap's output).  nullptr for indexed layers.
+		////////////////////////////////////////////////////////////
+		const std::uint32_t *colors;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Palette index of each pixel for indexed layers, where color 0 of each palette row (of 1 << bpp colors) is transparent.  nullptr otherwise.
+		////////////////////////////////////////////////////////////
+		const std::uint8_t *indices;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The 256 ARGB colors indices refers to.  nullptr for ARGB layers.
+		////////////////////////////////////////////////////////////
+		const std::uint32_t *palette;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Bits per pixel of the layer's graphics, which sets the size of a palette row (e.g. 2 for BG3 in mode 1, 4 for everything else).  Only used for indexed layers.
+		////////////////////////////////////////////////////////////
+		int bpp;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Priority of each pixel (0 - 1 for backgrounds, 0 - 3 for sprites), or nullptr if every pixel has priority 0
+		////////////////////////////////////////////////////////////
+		const std::uint8_t *priorities;
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief Makes a CompositorLayer out of ARGB pixels
+	///
+	/// \param layer		Which layer this is
+	/// \param colors		ARGB color of each pixel, where an alpha of 0 is transparent
+	/// \param priorities		Priority of each pixel, or nullptr if every pixel has priority 0
+	///
+	////////////////////////////////////////////////////////////
+	inline CompositorLayer makeCompositorLayer(ScreenLayer layer, const std::uint32_t *colors, const std::uint8_t *priorities = nullptr);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Makes a CompositorLayer out of palette indices
+	///
+	/// \param layer		Which layer this is
+	/// \param indices		Palette index of each pixel, where color 0 of each palette row is transparent
+	/// \param palette		The 256 ARGB colors the indices refer to
+	/// \param bpp			Bits per pixel of the layer's graphics.  A palette row is 1 << bpp colors, so in mode 1 this is 2 for BG3 and 4 for the other layers.
+	/// \param priorities		Priority of each pixel, or nullptr if every pixel has priority 0
+	///
+	////////////////////////////////////////////////////////////
+	inline CompositorLayer makeIndexedCompositorLayer(ScreenLayer layer, const std::uint8_t *indices, const std::uint32_t *palette, int bpp, const std::uint8_t *priorities = nullptr);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Combines drawn layers into one frame using the SNES's mode 1 priority rules (the mode SMW uses).
+	/// \details For every pixel, the frontmost non-transparent pixel of any layer wins, and the background color shows through where every layer is transparent.
+	/// From front to back, mode 1 draws:  BG3 with priority 1 (only if bg3Priority is set), sprites with priority 3, BG1 with priority 1, BG2 with priority 1, sprites with priority 2, BG1 with priority 0, BG2 with priority 0, sprites with priority 1, BG3 with priority 1 (if bg3Priority isn't set), sprites with priority 0, BG3 with priority 0.
+	///
+	/// Every layer (and out) must hold pixelCount pixels.  The order layers are passed in doesn't matter, and a layer type can be passed more than once (when it is, the one passed first wins ties).
+	/// The per-pixel work is done with masked selects instead of branches, several pixels at a time when SIMD is available.
+	///
+	/// \param layers		The layers to combine
+	/// \param layerCount		How many layers there are
+	/// \param pixelCount		How many pixels are in each layer
+	/// \param backgroundColor	The ARGB color behind every layer (e.g. from getLevelBackgroundColor).  Always drawn opaque.
+	/// \param out			Where to write the finished ARGB pixels
+	/// \param bg3Priority		Whether BG3 tiles with priority 1 go in front of everything, which is how SMW normally sets up the SNES
+	/// \param winningLayers	Will contain the ScreenLayer each pixel came from (ScreenLayer::Backdrop for the background color) if it is not nullptr.  Use this with makeColorMathMask.
+	///
+	////////////////////////////////////////////////////////////
+	inline void composeLayers(const CompositorLayer *layers, int layerCount, std::size_t pixelCount, std::uint32_t backgroundColor, std::uint32_t *out, bool bg3Priority = true, std::uint8_t *winningLayers = nullptr);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Turns composeLayers' winningLayers into a per-pixel mask for applyColorMath.
+	///
+	/// \param winningLayers	The layer each pixel came from, as filled in by composeLayers
+	/// \param pixelCount		How many pixels there are
+	/// \param enabledLayers	Which layers are selected, one bit per layer:  1 << ScreenLayer::BG1, 1 << ScreenLayer::BG2, etc.  For color math on the main screen this works like the SNES's CGADSUB register.
+	/// \param out			Will contain 1 for each pixel from a selected layer and 0 for every other pixel
+	///
+	////////////////////////////////////////////////////////////
+	inline void makeColorMathMask(const std::uint8_t *winningLayers, std::size_t pixelCount, int enabledLayers, std::uint8_t *out);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Blends the main screen with the sub screen using the SNES's color math rules.
+	/// \details Works on SFC (15-bit BGR) colors, so do this before converting to ARGB.  getLevelSFCPalette gives you colors in the right format, and composed ARGB frames made from SFCToARGB colors convert back with ARGBToSFC without losing anything.
+	///
+	/// Like the hardware, each 5-bit channel is blended on its own.  Where the sub screen is transparent (subCovered is 0), the fixed color is used instead and the result isn't halved.
+	/// Pixels are worked on 8 or 16 at a time with saturating SIMD adds and subtracts, and masks instead of branches.
+	///
+	/// \param mainColors		The main screen's colors
+	/// \param subColors		The sub screen's colors, or nullptr to blend with fixedColor everywhere (which is halved normally)
+	/// \param mathMask		Nonzero for each pixel color math applies to (see makeColorMathMask), or nullptr for every pixel.  Other pixels are copied from the main screen.
+	/// \param subCovered		Nonzero for each pixel where a sub screen layer isn't transparent, or nullptr if they all are covered.  Ignored if subColors is nullptr.
+	/// \param pixelCount		How many pixels there are
+	/// \param mode			How to combine the colors
+	/// \param fixedColor		The SNES's fixed color (COLDATA)
+	/// \param out			Where to write the blended SFC colors.  Can be the same as mainColors.
+	///
+	////////////////////////////////////////////////////////////
+	inline void applyColorMath(const std::uint16_t *mainColors, const std::uint16_t *subColors, const std::uint8_t *mathMask, const std::uint8_t *subCovered, std::size_t pixelCount, ColorMathMode mode, std::uint16_t fixedColor, std::uint16_t *out);
+
+
+//////////////////////////////////////////////////////////////////////////////
+///  @}
+//////////////////////////////////////////////////////////////////////////////
+}
+
+#include "Compositor.inl"
+
+#undef WORLDLIB_COMPOSITOR_SSE2
+#undef WORLDLIB_COMPOSITOR_AVX2
@@ -0,0 +1,311 @@
+#include "Internal.hpp"
+#include <algorithm>
+
+namespace worldlib
+{
+	namespace internal
+	{
+		// How far forward each layer and priority is drawn in mode 1.  Higher is closer to the front, and 0 is the background color.
+		// Indexed by [bg3Priority][layer][priority].
+		const std::uint32_t mode1LayerRanks[2][4][4] =
+		{
+			{	// BG3 priority bit off
+				{ 6, 9, 9, 9 },		// BG1
+				{ 5, 8, 8, 8 },		// BG2
+				{ 1, 3, 3, 3 },		// BG3
+				{ 2, 4, 7, 10 }		// Sprites
+			},
+			{	// BG3 priority bit on
+				{ 5, 8, 8, 8 },		// BG1
+				{ 4, 7, 7, 7 },		// BG2
+				{ 1, 10, 10, 10 },	// BG3
+				{ 2, 3, 6, 9 }		// Sprites
+			}
+		};
+
+		// Fills rankLayers with which layer drew a pixel, given the rank composeLayerChunk left it with.  Every (layer, priority) pair has its own rank, so this always works.
+		// It's worked out from mode1LayerRanks so the two can't disagree.
+		inline void getMode1RankLayers(bool bg3Priority, std::uint8_t (&rankLayers)[11])
+		{
+			rankLayers[0] = (std::uint8_t)ScreenLayer::Backdrop;
+			for (int layer = 0; layer < 4; layer++)
+				for (int priority = 0; priority < 4; priority++)
+					rankLayers[mode1LayerRanks[bg3Priority ? 1 : 0][layer][priority]] = (std::uint8_t)layer;
+		}
+
+		// The widest instructions composeLayers and applyColorMath were compiled to use
+		enum class CompositorInstructionSet : int
+		{
+			Plain = 0,
+			SSE2 = 1,
+			AVX2 = 2
+		};
+
+		inline CompositorInstructionSet getCompositorInstructionSet()
+		{
+#if defined(WORLDLIB_COMPOSITOR_AVX2)
+			return CompositorInstructionSet::AVX2;
+#elif defined(WORLDLIB_COMPOSITOR_SSE2)
+			return CompositorInstructionSet::SSE2;
+#else
+			return CompositorInstructionSet::Plain;
+#endif
+		}
+
+		// How many pixels are composed at once.  Small enough that the ranks, colors and indexed layer scratch space all stay in cache.
+		const std::size_t compositorChunkSize = 1024;
+
+		// Puts one layer's pixels over whatever's in front of them so far.
+		inline void composeLayerChunk(const std::uint32_t *colors, const std::uint8_t *priorities, const std::uint32_t *ranks, std::size_t count, std::uint32_t *result, std::uint32_t *bestRanks)
+		{
+			std::size_t i = 0;
+
+#ifdef WORLDLIB_COMPOSITOR_AVX2
+			__m256i rank0 = _mm256_set1_epi32(ranks[0]), rank1 = _mm256_set1_epi32(ranks[1]), rank2 = _mm256_set1_epi32(ranks[2]), rank3 = _mm256_set1_epi32(ranks[3]);
+			__m256i alphaMask = _mm256_set1_epi32(0xFF000000);
+			__m256i zero = _mm256_setzero_si256();
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256i color = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(colors + i));
+				__m256i rank = rank0;
+				if (priorities != nullptr)
+				{
+					__m256i priority = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(priorities + i)));
+					rank = _mm256_blendv_epi8(rank, rank1, _mm256_cmpeq_epi32(priority, _mm256_set1_epi32(1)));
+					rank = _mm256_blendv_epi8(rank, rank2, _mm256_cmpeq_epi32(priority, _mm256_set1_epi32(2)));
+					rank = _mm256_blendv_epi8(rank, rank3, _mm256_cmpgt_epi32(priority, _mm256_set1_epi32(2)));
+				}
+				__m256i transparent = _mm256_cmpeq_epi32(_mm256_and_si256(color, alphaMask), zero);
+				rank = _mm256_andnot_si256(transparent, rank);
+
+				__m256i best = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bestRanks + i));
+				__m256i take = _mm256_cmpgt_epi32(rank, best);
+				__m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(result + i));
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(result + i), _mm256_blendv_epi8(current, color, take));
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(bestRanks + i), _mm256_blendv_epi8(best, rank, take));
+			}
+#endif
+
+#ifdef WORLDLIB_COMPOSITOR_SSE2
+			__m128i rank0x = _mm_set1_epi32(ranks[0]), rank1x = _mm_set1_epi32(ranks[1]), rank2x = _mm_set1_epi32(ranks[2]), rank3x = _mm_set1_epi32(ranks[3]);
+			__m128i alphaMaskx = _mm_set1_epi32(0xFF000000);
+			__m128i zerox = _mm_setzero_si128();
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128i color = _mm_loadu_si128(reinterpret_cast<const __m128i *>(colors + i));
+				__m128i rank = rank0x;
+				if (priorities != nullptr)
+				{
+					std::int32_t packed;
+					std::copy(priorities + i, priorities + i + 4, reinterpret_cast<std::uint8_t *>(&packed));
+					__m128i priority = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zerox), zerox);
+
+					__m128i is1 = _mm_cmpeq_epi32(priority, _mm_set1_epi32(1));
+					__m128i is2 = _mm_cmpeq_epi32(priority, _mm_set1_epi32(2));
+					__m128i is3 = _mm_cmpgt_epi32(priority, _mm_set1_epi32(2));
+					rank = _mm_or_si128(_mm_and_si128(is1, rank1x), _mm_andnot_si128(is1, rank));
+					rank = _mm_or_si128(_mm_and_si128(is2, rank2x), _mm_andnot_si128(is2, rank));
+					rank = _mm_or_si128(_mm_and_si128(is3, rank3x), _mm_andnot_si128(is3, rank));
+				}
+				__m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(color, alphaMaskx), zerox);
+				rank = _mm_andnot_si128(transparent, rank);
+
+				__m128i best = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bestRanks + i));
+				__m128i take = _mm_cmpgt_epi32(rank, best);
+				__m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i *>(result + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(result + i), _mm_or_si128(_mm_and_si128(take, color), _mm_andnot_si128(take, current)));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(bestRanks + i), _mm_or_si128(_mm_and_si128(take, rank), _mm_andnot_si128(take, best)));
+			}
+#endif
+
+			for (; i < count; i++)
+			{
+				std::uint32_t color = colors[i];
+				std::uint32_t rank = ranks[priorities == nullptr ? 0 : std::min<int>(priorities[i], 3)];
+				rank &= 0u - (std::uint32_t)((color >> 24) != 0);				// Transparent pixels have rank 0, so they never win.
+				std::uint32_t take = 0u - (std::uint32_t)(rank > bestRanks[i]);
+				result[i] = (color & take) | (result[i] & ~take);
+				bestRanks[i] = (rank & take) | (bestRanks[i] & ~take);
+			}
+		}
+	}
+
+	inline CompositorLayer makeCompositorLayer(ScreenLayer layer, const std::uint32_t *colors, const std::uint8_t *priorities)
+	{
+		CompositorLayer result = { layer, colors, nullptr, nullptr, 0, priorities };
+		return result;
+	}
+
+	inline CompositorLayer makeIndexedCompositorLayer(ScreenLayer layer, const std::uint8_t *indices, const std::uint32_t *palette, int bpp, const std::uint8_t *priorities)
+	{
+		CompositorLayer result = { layer, nullptr, indices, palette, bpp, priorities };
+		return result;
+	}
+
+	inline void composeLayers(const CompositorLayer *layers, int layerCount, std::size_t pixelCount, std::uint32_t backgroundColor, std::uint32_t *out, bool bg3Priority, std::uint8_t *winningLayers)
+	{
+		std::uint32_t bestRanks[internal::compositorChunkSize];
+		std::uint32_t expanded[internal::compositorChunkSize];			// Indexed layers are turned into ARGB here first.
+		std::uint8_t rankLayers[11];
+		internal::getMode1RankLayers(bg3Priority, rankLayers);
+
+		for (std::size_t start = 0; start < pixelCount; start += internal::compositorChunkSize)
+		{
+			std::size_t count = std::min(internal::compositorChunkSize, pixelCount - start);
+			std::fill(out + start, out + start + count, backgroundColor | 0xFF000000);
+			std::fill(bestRanks, bestRanks + count, 0);
+
+			for (int l = 0; l < layerCount; l++)
+			{
+				const CompositorLayer &layer = layers[l];
+				const std::uint32_t *ranks = internal::mode1LayerRanks[bg3Priority ? 1 : 0][(int)layer.layer & 3];
+				const std::uint8_t *priorities = layer.priorities == nullptr ? nullptr : layer.priorities + start;
+				const std::uint32_t *colors;
+
+				if (layer.colors != nullptr)
+				{
+					colors = layer.colors + start;
+				}
+				else
+				{
+					int rowMask = (1 << layer.bpp) - 1;
+					for (std::size_t i = 0; i < count; i++)
+					{
+						std::uint8_t index = layer.indices[start + i];
+						expanded[i] = layer.palette[index] & (0x00FFFFFFu | ((0u - (std::uint32_t)((index & rowMask) != 0)) & 0xFF000000u));
+					}
+					colors = expanded;
+				}
+
+				internal::composeLayerChunk(colors, priorities, ranks, count, out + start, bestRanks);
+			}
+
+			if (winningLayers != nullptr)
+			{
+				for (std::size_t i = 0; i < count; i++)
+					winningLayers[start + i] = rankLayers[bestRanks[i]];
+			}
+		}
+	}
+
+	inline void makeColorMathMask(const std::uint8_t *winningLayers, std::size_t pixelCount, int enabledLayers, std::uint8_t *out)
+	{
+		for (std::size_t i = 0; i < pixelCount; i++)
+			out[i] = (enabledLayers >> (winningLayers[i] & 7)) & 1;
+	}
+
+	inline void applyColorMath(const std::uint16_t *mainColors, const std::uint16_t *subColors, const std::uint8_t *mathMask, const std::uint8_t *subCovered, std::size_t pixelCount, ColorMathMode mode, std::uint16_t fixedColor, std::uint16_t *out)
+	{
+		bool subtract = mode == ColorMathMode::Subtract || mode == ColorMathMode::SubtractHalf;
+		bool half = mode == ColorMathMode::AddHalf || mode == ColorMathMode::SubtractHalf;
+		if (subColors == nullptr) subCovered = nullptr;
+		std::size_t i = 0;
+
+		// Each channel is moved to the top 5 bits of its own 16-bit lane, so the saturating adds and subtracts clamp at exactly 31 and 0,
+		// and averaging (which is (a + b + 1) >> 1) leaves the +1 in bits the mask throws away.
+#ifdef WORLDLIB_COMPOSITOR_AVX2
+		{
+			__m256i channelMask = _mm256_set1_epi16((short)0xF800);
+			__m256i zero = _mm256_setzero_si256();
+			__m256i subtractMask = _mm256_set1_epi16(subtract ? -1 : 0);
+			__m256i halfMask = _mm256_set1_epi16(half ? -1 : 0);
+			__m256i fixed = _mm256_set1_epi16((short)fixedColor);
+			for (; i + 16 <= pixelCount; i += 16)
+			{
+				__m256i mainColor = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mainColors + i));
+				__m256i subColor = subColors == nullptr ? fixed : _mm256_loadu_si256(reinterpret_cast<const __m256i *>(subColors + i));
+				__m256i halve = halfMask;
+				if (subCovered != nullptr)
+				{
+					__m256i uncovered = _mm256_cmpeq_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(subCovered + i))), zero);
+					subColor = _mm256_blendv_epi8(subColor, fixed, uncovered);
+					halve = _mm256_andnot_si256(uncovered, halve);
+				}
+
+				__m256i mainChannels[3] = { _mm256_slli_epi16(mainColor, 11), _mm256_and_si256(_mm256_slli_epi16(mainColor, 6), channelMask), _mm256_and_si256(_mm256_slli_epi16(mainColor, 1), channelMask) };
+				__m256i subChannels[3] = { _mm256_slli_epi16(subColor, 11), _mm256_and_si256(_mm256_slli_epi16(subColor, 6), channelMask), _mm256_and_si256(_mm256_slli_epi16(subColor, 1), channelMask) };
+				__m256i results[3];
+				for (int c = 0; c < 3; c++)
+				{
+					__m256i difference = _mm256_subs_epu16(mainChannels[c], subChannels[c]);
+					__m256i full = _mm256_blendv_epi8(_mm256_adds_epu16(mainChannels[c], subChannels[c]), difference, subtractMask);
+					__m256i halved = _mm256_and_si256(_mm256_blendv_epi8(_mm256_avg_epu16(mainChannels[c], subChannels[c]), _mm256_avg_epu16(difference, zero), subtractMask), channelMask);
+					results[c] = _mm256_and_si256(_mm256_blendv_epi8(full, halved, halve), channelMask);		// Saturated adds also fill the low bits.
+				}
+
+				__m256i blended = _mm256_or_si256(_mm256_srli_epi16(results[0], 11), _mm256_or_si256(_mm256_srli_epi16(results[1], 6), _mm256_srli_epi16(results[2], 1)));
+				if (mathMask != nullptr)
+				{
+					__m256i skip = _mm256_cmpeq_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(mathMask + i))), zero);
+					blended = _mm256_blendv_epi8(blended, mainColor, skip);
+				}
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), blended);
+			}
+		}
+#endif
+
+#ifdef WORLDLIB_COMPOSITOR_SSE2
+		{
+			__m128i channelMask = _mm_set1_epi16((short)0xF800);
+			__m128i zero = _mm_setzero_si128();
+			__m128i subtractMask = _mm_set1_epi16(subtract ? -1 : 0);
+			__m128i halfMask = _mm_set1_epi16(half ? -1 : 0);
+			__m128i fixed = _mm_set1_epi16((short)fixedColor);
+			for (; i + 8 <= pixelCount; i += 8)
+			{
+				__m128i mainColor = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mainColors + i));
+				__m128i subColor = subColors == nullptr ? fixed : _mm_loadu_si128(reinterpret_cast<const __m128i *>(subColors + i));
+				__m128i halve = halfMask;
+				if (subCovered != nullptr)
+				{
+					__m128i uncovered = _mm_cmpeq_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(subCovered + i)), zero), zero);
+					subColor = _mm_or_si128(_mm_and_si128(uncovered, fixed), _mm_andnot_si128(uncovered, subColor));
+					halve = _mm_andnot_si128(uncovered, halve);
+				}
+
+				__m128i mainChannels[3] = { _mm_slli_epi16(mainColor, 11), _mm_and_si128(_mm_slli_epi16(mainColor, 6), channelMask), _mm_and_si128(_mm_slli_epi16(mainColor, 1), channelMask) };
+				__m128i subChannels[3] = { _mm_slli_epi16(subColor, 11), _mm_and_si128(_mm_slli_epi16(subColor, 6), channelMask), _mm_and_si128(_mm_slli_epi16(subColor, 1), channelMask) };
+				__m128i results[3];
+				for (int c = 0; c < 3; c++)
+				{
+					__m128i sum = _mm_adds_epu16(mainChannels[c], subChannels[c]);
+					__m128i difference = _mm_subs_epu16(mainChannels[c], subChannels[c]);
+					__m128i full = _mm_or_si128(_mm_and_si128(subtractMask, difference), _mm_andnot_si128(subtractMask, sum));
+					__m128i halvedSum = _mm_avg_epu16(mainChannels[c], subChannels[c]);
+					__m128i halvedDifference = _mm_avg_epu16(difference, zero);
+					__m128i halved = _mm_and_si128(_mm_or_si128(_mm_and_si128(subtractMask, halvedDifference), _mm_andnot_si128(subtractMask, halvedSum)), channelMask);
+					results[c] = _mm_and_si128(_mm_or_si128(_mm_and_si128(halve, halved), _mm_andnot_si128(halve, full)), channelMask);		// Saturated adds also fill the low bits.
+				}
+
+				__m128i blended = _mm_or_si128(_mm_srli_epi16(results[0], 11), _mm_or_si128(_mm_srli_epi16(results[1], 6), _mm_srli_epi16(results[2], 1)));
+				if (mathMask != nullptr)
+				{
+					__m128i skip = _mm_cmpeq_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(mathMask + i)), zero), zero);
+					blended = _mm_or_si128(_mm_and_si128(skip, mainColor), _mm_andnot_si128(skip, blended));
+				}
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), blended);
+			}
+		}
+#endif
+
+		for (; i < pixelCount; i++)
+		{
+			int mainColor = mainColors[i];
+			bool covered = subCovered == nullptr || subCovered[i] != 0;
+			int subColor = (subColors == nullptr || covered == false) ? fixedColor : subColors[i];
+			bool halve = half && covered;
+
+			int blended = 0;
+			for (int shift = 0; shift < 15; shift += 5)
+			{
+				int a = (mainColor >> shift) & 0x1F;
+				int b = (subColor >> shift) & 0x1F;
+				int full = subtract ? std::max(a - b, 0) : std::min(a + b, 0x1F);
+				int halved = (subtract ? std::max(a - b, 0) : a + b) >> 1;
+				blended |= (halve ? halved : full) << shift;
+			}
+
+			out[i] = (mathMask == nullptr || mathMask[i] != 0) ? (std::uint16_t)blended : (std::uint16_t)mainColor;
+		}
+	}
+}
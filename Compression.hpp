@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include "Result.hpp"
 
 #ifndef WORLDLIB_IGNORE_DLL_FUNCTIONS
 #include <Windows.h>
@@ -33,7 +34,7 @@ namespace worldlib
 	///
 	/// \return Iterator pointing to the end of your decompressed data
 	///
-	/// \throws std::runtime_error An error occurred while decompressing the data.  Either there was an unrecognized bit sequence or there was not enough data to decompress
+	/// \throws std::runtime_error An error occurred while decompressing the data.  Either there was an unrecognized bit sequence, there was not enough data to decompress, or the data copied from somewhere that hadn't been decompressed yet
 	///
 	/// \see decompressGraphicsFile, decompressData
 	///
@@ -53,7 +54,7 @@ namespace worldlib
 	///
 	/// \return Iterator pointing to the end of your decompressed data
 	///
-	/// \throws std::runtime_error An error occurred while decompressing the data.  Either there was an unrecognized bit sequence or there was not enough data to decompress
+	/// \throws std::runtime_error An error occurred while decompressing the data.  Either there was an unrecognized bit sequence, there was not enough data to decompress, or the data copied from somewhere that hadn't been decompressed yet
 	///
 	/// \see decompressGraphicsFile, decompressData
 	///
@@ -74,7 +75,7 @@ namespace worldlib
 	///
 	/// \return Iterator pointing to the end of your decompressed data
 	///
-	/// \throws std::runtime_error An error occurred while decompressing the data.  Either there was an unrecognized bit sequence or there was not enough data to decompress
+	/// \throws std::runtime_error An error occurred while decompressing the data.  Either there was an unrecognized bit sequence, there was not enough data to decompress, or the data copied from somewhere that hadn't been decompressed yet
 	///
 	/// \see decompressGraphicsFile
 	///
@@ -82,6 +83,32 @@ namespace worldlib
 	template <typename romIteratorType, typename inputIteratorType, typename outputIteratorType>
 	outputIteratorType decompressData(romIteratorType romStart, romIteratorType romEnd, inputIteratorType compressedDataStart, inputIteratorType compressedDataEnd, outputIteratorType out, int *compressedSize = nullptr, int *decompressedSize = nullptr);
 
+	////////////////////////////////////////////////////////////
+	/// \brief Same as decompressLZ2, but returns an error instead of throwing.  decompressLZ2 is a wrapper around this.
+	/// \details Bad data never throws, but out and the vector used while decompressing can (e.g. std::bad_alloc), so this isn't noexcept.
+	/// Nothing is written to out unless decompression succeeds.  compressedSize and decompressedSize are set either way, to how far decompression got before the error.
+	///
+	/// \return Iterator pointing to the end of your decompressed data, or ErrorCode::UnexpectedEndOfData, ErrorCode::UnknownCompressionCommand or ErrorCode::InvalidBackReference
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType, typename outputIteratorType>
+	Result<outputIteratorType> tryDecompressLZ2(inputIteratorType compressedDataStart, inputIteratorType compressedDataEnd, outputIteratorType out, int *compressedSize = nullptr, int *decompressedSize = nullptr);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Same as decompressLZ3, but returns an error instead of throwing.  See tryDecompressLZ2.
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType, typename outputIteratorType>
+	Result<outputIteratorType> tryDecompressLZ3(inputIteratorType compressedDataStart, inputIteratorType compressedDataEnd, outputIteratorType out, int *compressedSize = nullptr, int *decompressedSize = nullptr);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Same as decompressData, but returns an error instead of throwing.  See tryDecompressLZ2.
+	///
+	/// \return Iterator pointing to the end of your decompressed data, or an error from tryDecompressLZ2, tryDecompressLZ3 or tryReadByteSFC, or ErrorCode::UnrecognizedCompressionFormat
+	///
+	////////////////////////////////////////////////////////////
+	template <typename romIteratorType, typename inputIteratorType, typename outputIteratorType>
+	Result<outputIteratorType> tryDecompressData(romIteratorType romStart, romIteratorType romEnd, inputIteratorType compressedDataStart, inputIteratorType compressedDataEnd, outputIteratorType out, int *compressedSize = nullptr, int *decompressedSize = nullptr);
+
 	// Compression functions all rely on the Lunar Compress DLL
 	#ifndef WORLDLIB_IGNORE_DLL_FUNCTIONS
 
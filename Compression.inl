@@ -5,27 +5,53 @@
 #include <cstdint>
 #include <algorithm>
 #include "Internal.hpp"
+#include "Instrumentation.hpp"
 
-#define _SFCLIB_INTEGER_ITERATOR_ASSERT(type) static_assert(std::numeric_limits<std::iterator_traits<type>::value_type>::is_integer == true, "The iterator type must have a value_type that is an integer.  8-bit integers recommended.")
+#define _SFCLIB_INTEGER_ITERATOR_ASSERT(type) static_assert(std::numeric_limits<typename std::iterator_traits<type>::value_type>::is_integer == true, "The iterator type must have a value_type that is an integer.  8-bit integers recommended.")
 
 namespace worldlib
 {
 
 	namespace internal
 	{
-		template <typename inputIteratorType>
-		inline auto getCompressionByte(inputIteratorType &start, inputIteratorType end, int *compressedSize) -> decltype(*start)
+		// Gets the next byte of compressed data.  Returns false if there isn't one.
+		template <typename inputIteratorType, typename byteType>
+		inline bool readCompressionByte(inputIteratorType &start, inputIteratorType end, int &compressedSize, byteType &byte) noexcept
 		{
-			if (start >= end) throw std::runtime_error("Unexpected end reached.");
+			if (start >= end) return false;
 
-			if (compressedSize != nullptr) *compressedSize += 1;
+			compressedSize++;
+			byte = *(start++);
+			return true;
+		}
+	}
+
+// Reads the next compressed byte into variable, or fails the decompression if the data has run out.
+#define _SFCLIB_NEXT_COMPRESSION_BYTE(variable) if (!internal::readCompressionByte(start, end, bytesRead, variable)) return internal::finishDecompression(resultBuffer, out, bytesRead, compressedSize, decompressedSize, ErrorCode::UnexpectedEndOfData)
 
-			return *(start++);
+	namespace internal
+	{
+		// Reports the sizes, and on success writes the decompressed data to out.  Nothing is written on failure.
+		template <typename bufferType, typename outputIteratorType>
+		Result<outputIteratorType> finishDecompression(const bufferType &resultBuffer, outputIteratorType out, int bytesRead, int *compressedSize, int *decompressedSize, ErrorCode error)
+		{
+			if (compressedSize != nullptr)
+				*compressedSize = bytesRead;
+			if (decompressedSize != nullptr)
+				*decompressedSize = resultBuffer.size();
+
+			if (error != ErrorCode::None)
+				return error;
+
+			for (unsigned int i = 0; i < resultBuffer.size(); i++)
+				*(out++) = resultBuffer[i];
+
+			return out;
 		}
 	}
 
 template <typename inputIteratorType, typename outputIteratorType>
-outputIteratorType decompressLZ2(inputIteratorType start, inputIteratorType end, outputIteratorType out, int *compressedSize, int *decompressedSize)
+Result<outputIteratorType> tryDecompressLZ2(inputIteratorType start, inputIteratorType end, outputIteratorType out, int *compressedSize, int *decompressedSize)
 {
 	_SFCLIB_INTEGER_ITERATOR_ASSERT(inputIteratorType);
 
@@ -42,26 +68,23 @@ outputIteratorType decompressLZ2(inputIteratorType start, inputIteratorType end,
 	};
 	
 	// Used internally.  On success out is modified.
-	std::vector<typename std::iterator_traits<inputIteratorType>::value_type> resultBuffer;
-
-
-	if (compressedSize != nullptr)
-		*compressedSize = 0;
+	typedef typename std::iterator_traits<inputIteratorType>::value_type byteType;
+	std::vector<byteType> resultBuffer;
+	int bytesRead = 0;
 
 
 	while (start != end)
 	{
-		if (decompressedSize != nullptr)
-			*decompressedSize = resultBuffer.size();
-
 		int runLength;
-		auto headerByte = internal::getCompressionByte(start, end, compressedSize);
+		byteType headerByte;
+		_SFCLIB_NEXT_COMPRESSION_BYTE(headerByte);
 		if (headerByte == 0xFF) break;
 		CommandType commandType = static_cast<CommandType>((headerByte & 0xE0) >> 5);
 
 		if (commandType == LongCommand)
 		{
-			auto secondHeaderByte = internal::getCompressionByte(start, end, compressedSize);
+			byteType secondHeaderByte;
+			_SFCLIB_NEXT_COMPRESSION_BYTE(secondHeaderByte);
 			commandType = static_cast<CommandType>((headerByte & 0x1C) >> 2);
 			runLength = ((headerByte & 0x3) << 8) | secondHeaderByte;
 		}
@@ -74,14 +97,16 @@ outputIteratorType decompressLZ2(inputIteratorType start, inputIteratorType end,
 		{
 			while (runLength >= 0)
 			{
-				auto byte = internal::getCompressionByte(start, end, compressedSize);
+				byteType byte;
+				_SFCLIB_NEXT_COMPRESSION_BYTE(byte);
 				resultBuffer.push_back(byte);
 				runLength--;
 			}
 		}
 		else if (commandType == ByteFill)				// The data for this chunk is one stream of one byte
 		{
-			auto fillByte = internal::getCompressionByte(start, end, compressedSize);
+			byteType fillByte;
+			_SFCLIB_NEXT_COMPRESSION_BYTE(fillByte);
 			while (runLength >= 0)
 			{
 				resultBuffer.push_back(fillByte);
@@ -90,8 +115,9 @@ outputIteratorType decompressLZ2(inputIteratorType start, inputIteratorType end,
 		}
 		else if (commandType == WordFill)				// The data for this chunk is one stream of two alternating bytes.
 		{
-			auto fillByte1 = internal::getCompressionByte(start, end, compressedSize);
-			auto fillByte2 = internal::getCompressionByte(start, end, compressedSize);
+			byteType fillByte1, fillByte2;
+			_SFCLIB_NEXT_COMPRESSION_BYTE(fillByte1);
+			_SFCLIB_NEXT_COMPRESSION_BYTE(fillByte2);
 			bool useFirst = true;
 			while (runLength >= 0)
 			{
@@ -106,7 +132,8 @@ outputIteratorType decompressLZ2(inputIteratorType start, inputIteratorType end,
 		}
 		else if (commandType == IncreasingFill)				// The data for this chunk is one byte increasing in value
 		{
-			auto fillByte = internal::getCompressionByte(start, end, compressedSize);
+			byteType fillByte;
+			_SFCLIB_NEXT_COMPRESSION_BYTE(fillByte);
 			while (runLength >= 0)
 			{
 				resultBuffer.push_back(fillByte);
@@ -117,9 +144,15 @@ outputIteratorType decompressLZ2(inputIteratorType start, inputIteratorType end,
 		}
 		else if (commandType == Repeat)					// The data for this chunk copies previously written data
 		{
-			int offset = (internal::getCompressionByte(start, end, compressedSize) << 0x8) | (internal::getCompressionByte(start, end, compressedSize));	// Big endian, for some reason...
+			byteType offsetHigh, offsetLow;
+			_SFCLIB_NEXT_COMPRESSION_BYTE(offsetHigh);
+			_SFCLIB_NEXT_COMPRESSION_BYTE(offsetLow);
+			int offset = (offsetHigh << 0x8) | offsetLow;	// Big endian, for some reason...
 			int i = 0;
 
+			if (offset >= (int)resultBuffer.size())
+				return internal::finishDecompression(resultBuffer, out, bytesRead, compressedSize, decompressedSize, ErrorCode::InvalidBackReference);
+
 			while (runLength >= 0)
 			{
 				resultBuffer.push_back(resultBuffer[offset + i]);
@@ -129,20 +162,23 @@ outputIteratorType decompressLZ2(inputIteratorType start, inputIteratorType end,
 		}
 		else
 		{
-			throw std::runtime_error("Unknown command bit sequence.");
+			return internal::finishDecompression(resultBuffer, out, bytesRead, compressedSize, decompressedSize, ErrorCode::UnknownCompressionCommand);
 		}
 	}
 
-	for (unsigned int i = 0; i < resultBuffer.size(); i++)
-		*(out++) = resultBuffer[i];
+	return internal::finishDecompression(resultBuffer, out, bytesRead, compressedSize, decompressedSize, ErrorCode::None);
+}
 
-	return out;
+template <typename inputIteratorType, typename outputIteratorType>
+outputIteratorType decompressLZ2(inputIteratorType start, inputIteratorType end, outputIteratorType out, int *compressedSize, int *decompressedSize)
+{
+	return tryDecompressLZ2(start, end, out, compressedSize, decompressedSize).value();
 }
 
 
 
 template <typename inputIteratorType, typename outputIteratorType>
-outputIteratorType decompressLZ3(inputIteratorType start, inputIteratorType end, outputIteratorType out, int *compressedSize, int *decompressedSize)
+Result<outputIteratorType> tryDecompressLZ3(inputIteratorType start, inputIteratorType end, outputIteratorType out, int *compressedSize, int *decompressedSize)
 {
 	_SFCLIB_INTEGER_ITERATOR_ASSERT(inputIteratorType);
 
@@ -159,22 +195,23 @@ outputIteratorType decompressLZ3(inputIteratorType start, inputIteratorType end,
 	};
 
 	// Used internally.  On success out is modified.
-	std::vector<typename std::iterator_traits<inputIteratorType>::value_type> resultBuffer;
-
-	if (compressedSize != nullptr)
-		*compressedSize = 0;
+	typedef typename std::iterator_traits<inputIteratorType>::value_type byteType;
+	std::vector<byteType> resultBuffer;
+	int bytesRead = 0;
 
 
 	while (start != end)
 	{
 		int runLength;
-		auto headerByte = internal::getCompressionByte(start, end, compressedSize);
+		byteType headerByte;
+		_SFCLIB_NEXT_COMPRESSION_BYTE(headerByte);
 		if (headerByte == 0xFF) break;
 		CommandType commandType = static_cast<CommandType>((headerByte & 0xE0) >> 5);
 
 		if (commandType == LongCommand)
 		{
-			auto secondHeaderByte = internal::getCompressionByte(start, end, compressedSize);
+			byteType secondHeaderByte;
+			_SFCLIB_NEXT_COMPRESSION_BYTE(secondHeaderByte);
 			commandType = static_cast<CommandType>((headerByte & 0x1C) >> 2);
 			runLength = ((headerByte & 0x3) << 8) | secondHeaderByte;
 		}
@@ -187,13 +224,16 @@ outputIteratorType decompressLZ3(inputIteratorType start, inputIteratorType end,
 		{
 			while (runLength >= 0)
 			{
-				resultBuffer.push_back(internal::getCompressionByte(start, end, compressedSize));
+				byteType byte;
+				_SFCLIB_NEXT_COMPRESSION_BYTE(byte);
+				resultBuffer.push_back(byte);
 				runLength--;
 			}
 		}
 		else if (commandType == ByteFill)				// The data for this chunk is one stream of one byte
 		{
-			auto fillByte = internal::getCompressionByte(start, end, compressedSize);
+			byteType fillByte;
+			_SFCLIB_NEXT_COMPRESSION_BYTE(fillByte);
 			while (runLength >= 0)
 			{
 				resultBuffer.push_back(fillByte);
@@ -202,8 +242,9 @@ outputIteratorType decompressLZ3(inputIteratorType start, inputIteratorType end,
 		}
 		else if (commandType == WordFill)				// The data for this chunk is one stream of two alternating bytes.
 		{
-			auto fillByte1 = internal::getCompressionByte(start, end, compressedSize);
-			auto fillByte2 = internal::getCompressionByte(start, end, compressedSize);
+			byteType fillByte1, fillByte2;
+			_SFCLIB_NEXT_COMPRESSION_BYTE(fillByte1);
+			_SFCLIB_NEXT_COMPRESSION_BYTE(fillByte2);
 			bool useFirst = true;
 			while (runLength >= 0)
 			{
@@ -230,19 +271,30 @@ outputIteratorType decompressLZ3(inputIteratorType start, inputIteratorType end,
 			int offset = 0;
 			int incrementDirection = 1;
 
-			auto firstByte = internal::getCompressionByte(start, end, compressedSize);
+			byteType firstByte;
+			_SFCLIB_NEXT_COMPRESSION_BYTE(firstByte);
 
 			// The offset is either relative to the current buffer position or a fixed point from the beginning.
 			if ((firstByte & 0x80) == 0x80) 
+			{
 				offset = resultBuffer.size() - (firstByte & 0x7F) - 1;
+			}
 			else
-				offset = (firstByte & 0x7F) * 0x100 + internal::getCompressionByte(start, end, compressedSize);
+			{
+				byteType secondByte;
+				_SFCLIB_NEXT_COMPRESSION_BYTE(secondByte);
+				offset = (firstByte & 0x7F) * 0x100 + secondByte;
+			}
 
 			if (commandType == Repeat || commandType == BitReverseRepeat)
 				incrementDirection = 1;
 			else if (commandType == BackwardsRepeat) 
 				incrementDirection = -1;
 
+			// Forwards copies can read what they've just written, but backwards ones have to stay within what's already there.
+			if (offset < 0 || offset >= (int)resultBuffer.size() || (incrementDirection == -1 && offset - runLength < 0))
+				return internal::finishDecompression(resultBuffer, out, bytesRead, compressedSize, decompressedSize, ErrorCode::InvalidBackReference);
+
 			bool reverseBits = commandType == BitReverseRepeat;
 
 			int i = 0;
@@ -258,30 +310,54 @@ outputIteratorType decompressLZ3(inputIteratorType start, inputIteratorType end,
 		}
 		else
 		{
-			throw std::runtime_error("Unknown command bit sequence.");
+			return internal::finishDecompression(resultBuffer, out, bytesRead, compressedSize, decompressedSize, ErrorCode::UnknownCompressionCommand);
 		}
 	}
 
-	for (unsigned int i = 0; i < resultBuffer.size(); i++)
-		*(out++) = resultBuffer[i];
+	return internal::finishDecompression(resultBuffer, out, bytesRead, compressedSize, decompressedSize, ErrorCode::None);
+}
+
+template <typename inputIteratorType, typename outputIteratorType>
+outputIteratorType decompressLZ3(inputIteratorType start, inputIteratorType end, outputIteratorType out, int *compressedSize, int *decompressedSize)
+{
+	return tryDecompressLZ3(start, end, out, compressedSize, decompressedSize).value();
+}
+
+#undef _SFCLIB_NEXT_COMPRESSION_BYTE
+
+template <typename romIteratorType, typename inputIteratorType, typename outputIteratorType>
+Result<outputIteratorType> tryDecompressData(romIteratorType romStart, romIteratorType romEnd, inputIteratorType compressedDataStart, inputIteratorType compressedDataEnd, outputIteratorType out, int *compressedSize, int *decompressedSize)
+{
+	WORLDLIB_INSTRUMENT(DecompressData);
+
+#ifdef WORLDLIB_INSTRUMENTATION
+	int instrumentedCompressedSize, instrumentedDecompressedSize;		// The sizes are needed for the counters even if the caller doesn't want them.
+	if (compressedSize == nullptr) compressedSize = &instrumentedCompressedSize;
+	if (decompressedSize == nullptr) decompressedSize = &instrumentedDecompressedSize;
+#endif
+
+	auto compressionType = tryReadByteSFC(romStart, romEnd, internal::decompressionTypeLocation);
+	if (!compressionType) return compressionType.error();
 
-	if (decompressedSize != nullptr)
-		*decompressedSize = resultBuffer.size();
+	Result<outputIteratorType> result = ErrorCode::UnrecognizedCompressionFormat;
+	if (compressionType.value() == 0 || compressionType.value() == 1)
+		result = tryDecompressLZ2(compressedDataStart, compressedDataEnd, out, compressedSize, decompressedSize);
+	else if (compressionType.value() == 2)
+		result = tryDecompressLZ3(compressedDataStart, compressedDataEnd, out, compressedSize, decompressedSize);
 
-	return out;
+	if (result)
+	{
+		WORLDLIB_COUNT(CompressedBytesRead, *compressedSize);
+		WORLDLIB_COUNT(BytesDecompressed, *decompressedSize);
+	}
+	return result;
 }
 
 template <typename romIteratorType, typename inputIteratorType, typename outputIteratorType>
 outputIteratorType decompressData(romIteratorType romStart, romIteratorType romEnd, inputIteratorType compressedDataStart, inputIteratorType compressedDataEnd, outputIteratorType out, int *compressedSize, int *decompressedSize)
 {
-	auto compressionType = readByteSFC(romStart, romEnd, internal::decompressionTypeLocation);
-
-	if (compressionType == 0 || compressionType == 1)
-		return decompressLZ2(compressedDataStart, compressedDataEnd, out, compressedSize, decompressedSize);
-	else if (compressionType == 2)
-		return decompressLZ3(compressedDataStart, compressedDataEnd, out, compressedSize, decompressedSize);
-	else
-		throw std::runtime_error("Unrecognized compression format.");
+	WORLDLIB_INSTRUMENT(DecompressData);		// Also here so exceptions thrown by the wrapper are counted
+	return tryDecompressData(romStart, romEnd, compressedDataStart, compressedDataEnd, out, compressedSize, decompressedSize).value();
 }
 
 #ifndef WORLDLIB_IGNORE_DLL_FUNCTIONS
@@ -0,0 +1,143 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "Level.hpp"
+
+namespace worldlib
+{
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file GraphicsDirectory.hpp
+/// \brief Contains a class that finds every graphics file in the ROM at once.
+///
+/// \addtogroup Level
+///  @{
+//////////////////////////////////////////////////////////////////////////////
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief Information about a single graphics file in a GraphicsDirectory
+	////////////////////////////////////////////////////////////
+	struct GraphicsFileEntry
+	{
+		////////////////////////////////////////////////////////////
+		/// \brief Same as romContainsGraphicsFile.  True for file 0x7F.
+		////////////////////////////////////////////////////////////
+		bool exists;
+
+		////////////////////////////////////////////////////////////
+		/// \brief SNES address of the file, or -1 if it doesn't exist (or is file 0x7F)
+		////////////////////////////////////////////////////////////
+		int address;
+
+		////////////////////////////////////////////////////////////
+		/// \brief PC offset of the file (from the start of the ROM data), or -1 if it doesn't exist (or is file 0x7F)
+		////////////////////////////////////////////////////////////
+		int pcOffset;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Size of the compressed data in bytes, or -1 if the file doesn't exist or couldn't be decompressed
+		////////////////////////////////////////////////////////////
+		int compressedSize;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Size of the decompressed data in bytes, or -1 if the file doesn't exist or couldn't be decompressed
+		////////////////////////////////////////////////////////////
+		int decompressedSize;
+
+		////////////////////////////////////////////////////////////
+		/// \brief 64-bit FNV-1a hash of the compressed data, or 0 if the file doesn't exist or couldn't be decompressed.  Good for cache keys.
+		////////////////////////////////////////////////////////////
+		std::uint64_t hash;
+	};
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief Finds every graphics file in the ROM (GFX00-31, ExGFX80-FF and ExGFX100-FFF) once, along with their sizes and hashes.
+	/// \details getAddressOfGraphicsFile and romContainsGraphicsFile have to follow the pointer tables every time they're called.
+	/// This follows them once for every file and keeps the results in one flat table indexed by file number, so checking whether a file exists, how big it is, or whether it changed is just an array access.
+	/// Building the directory decompresses every file once to find its size.
+	///
+	/// The directory is a snapshot:  if the ROM changes, you'll need to make a new one.
+	////////////////////////////////////////////////////////////
+	class GraphicsDirectory
+	{
+	public:
+
+		////////////////////////////////////////////////////////////
+		/// \brief How many entries the directory holds (one for every possible file number from 0 to 0xFFF)
+		////////////////////////////////////////////////////////////
+		static const int fileCount = 0x1000;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Creates an empty directory.  No file exists.
+		////////////////////////////////////////////////////////////
+		GraphicsDirectory();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Finds every graphics file in the ROM.
+		///
+		/// \param romStart		An iterator pointing to the beginning of the ROM data
+		/// \param romEnd		An iterator pointing to the end of the ROM data
+		///
+		/// \throws std::runtime_error If the graphics pointer tables can't be read, in the same cases romContainsGraphicsFile would throw.  Files that exist but can't be decompressed don't throw; they just have no sizes or hash.
+		///
+		////////////////////////////////////////////////////////////
+		template <typename inputIteratorType>
+		GraphicsDirectory(inputIteratorType romStart, inputIteratorType romEnd);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns true if the specified graphics file exists.  Same as romContainsGraphicsFile.
+		///
+		/// \param file			The graphics file to check
+		///
+		////////////////////////////////////////////////////////////
+		bool contains(int file) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns everything known about the specified graphics file.
+		///
+		/// \param file			The graphics file to get
+		///
+		/// \throws std::runtime_error If the file number is not between 0 and 0xFFF
+		///
+		////////////////////////////////////////////////////////////
+		const GraphicsFileEntry &getEntry(int file) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the SNES address of the specified graphics file.  Same as getAddressOfGraphicsFile.
+		///
+		/// \param file			The graphics file to get the address of
+		///
+		/// \return SNES address of the file in the ROM.  Returns -1 for file 0x7F.
+		///
+		/// \throws std::runtime_error If the graphics file does not exist in the ROM or is otherwise invalid
+		///
+		////////////////////////////////////////////////////////////
+		int getAddress(int file) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the combined compressed size of every graphics file that could be decompressed
+		////////////////////////////////////////////////////////////
+		long long getTotalCompressedSize() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the combined decompressed size of every graphics file that could be decompressed
+		////////////////////////////////////////////////////////////
+		long long getTotalDecompressedSize() const;
+
+	protected:
+
+		////////////////////////////////////////////////////////////
+		/// \brief One entry per file number
+		////////////////////////////////////////////////////////////
+		std::vector<GraphicsFileEntry> entries;
+	};
+
+
+//////////////////////////////////////////////////////////////////////////////
+///  @}
+//////////////////////////////////////////////////////////////////////////////
+}
+
+#include "GraphicsDirectory.inl"
@@ -0,0 +1,119 @@
+#include "Internal.hpp"
+#include <stdexcept>
+#include <iterator>
+
+namespace worldlib
+{
+	namespace internal
+	{
+		// 64-bit FNV-1a.
+		template <typename inputIteratorType>
+		std::uint64_t hashBytes(inputIteratorType start, inputIteratorType end)
+		{
+			std::uint64_t hash = 0xCBF29CE484222325ULL;
+			for (; start != end; ++start)
+			{
+				hash ^= static_cast<std::uint8_t>(*start);
+				hash *= 0x100000001B3ULL;
+			}
+			return hash;
+		}
+	}
+
+	inline GraphicsDirectory::GraphicsDirectory()
+	{
+		GraphicsFileEntry missing = { false, -1, -1, -1, -1, 0 };
+		entries.assign(fileCount, missing);
+	}
+
+	template <typename inputIteratorType>
+	GraphicsDirectory::GraphicsDirectory(inputIteratorType romStart, inputIteratorType romEnd) : GraphicsDirectory()
+	{
+		// Follow each pointer-to-pointer-table once instead of once per file.  Lookups share internal::findGraphicsFile with getAddressOfGraphicsFile, so the two always agree.
+		auto tables = internal::readGraphicsFileTables(romStart, romEnd);
+		auto romSize = std::distance(romStart, romEnd);
+
+		std::vector<std::uint8_t> scratch;
+
+		for (int file = 0; file < fileCount; file++)
+		{
+			GraphicsFileEntry &entry = entries[file];
+
+			int address = 0;
+			ErrorCode error = ErrorCode::None;
+			auto status = internal::findGraphicsFile(romStart, romEnd, tables, file, address, error);
+			if (status == internal::GraphicsFileStatus::Unreadable)
+				internal::throwError(error);
+			if (status == internal::GraphicsFileStatus::Placeholder)
+				entry.exists = true;
+			if (status != internal::GraphicsFileStatus::Exists)
+				continue;
+
+			entry.exists = true;
+			entry.address = address;
+
+			// Files whose data can't be reached or decompressed still exist, they just don't get sizes or a hash.
+			auto pcOffset = trySFCToPC(romStart, romEnd, address);
+			if (!pcOffset)
+				continue;
+			entry.pcOffset = pcOffset.value();
+			if (entry.pcOffset >= romSize)
+				continue;
+
+			auto fileStart = romStart;
+			std::advance(fileStart, entry.pcOffset);
+
+			int compressedSize = 0;
+			scratch.clear();
+			if (!tryDecompressData(romStart, romEnd, fileStart, romEnd, std::back_inserter(scratch), &compressedSize))
+				continue;
+
+			auto fileEnd = fileStart;
+			std::advance(fileEnd, compressedSize);
+
+			entry.compressedSize = compressedSize;
+			entry.decompressedSize = (int)scratch.size();
+			entry.hash = internal::hashBytes(fileStart, fileEnd);
+		}
+	}
+
+	inline bool GraphicsDirectory::contains(int file) const
+	{
+		if (file < 0 || file >= fileCount) return false;
+		return entries[file].exists;
+	}
+
+	inline const GraphicsFileEntry &GraphicsDirectory::getEntry(int file) const
+	{
+		if (file < 0 || file >= fileCount)
+			throw std::runtime_error("ExGFX file is not valid.");
+		return entries[file];
+	}
+
+	inline int GraphicsDirectory::getAddress(int file) const
+	{
+		if (file == 0x7F)
+			return -1;
+		if ((file < 0 || file > 0x31) && (file < 0x80 || file > 0xFFF))
+			throw std::runtime_error("ExGFX file is not valid.");
+		if (entries[file].exists == false)
+			throw std::runtime_error("ExGFX file does not exist.");
+		return entries[file].address;
+	}
+
+	inline long long GraphicsDirectory::getTotalCompressedSize() const
+	{
+		long long total = 0;
+		for (const auto &entry : entries)
+			if (entry.compressedSize > 0) total += entry.compressedSize;
+		return total;
+	}
+
+	inline long long GraphicsDirectory::getTotalDecompressedSize() const
+	{
+		long long total = 0;
+		for (const auto &entry : entries)
+			if (entry.decompressedSize > 0) total += entry.decompressedSize;
+		return total;
+	}
+}
@@ -0,0 +1,191 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include "Level.hpp"
+#include "LevelIndex.hpp"
+#include "Internal.hpp"
+
+namespace worldlib
+{
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file GraphicsUsageIndex.hpp
+/// \brief Contains a class that tracks which levels use which graphics files.
+///
+/// \addtogroup Level
+///  @{
+//////////////////////////////////////////////////////////////////////////////
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief Maps each graphics file to the levels (and slots) that use it.
+	/// \details The reverse of getLevelGraphicsSlots:  instead of asking which files a level uses, ask which levels use a file.
+	/// Useful for working out what needs to be redrawn after a graphics file is edited.
+	///
+	/// Each file gets a bitset with one bit per level, so looking up a file's levels doesn't touch any other file's data.
+	/// Which of a level's slots the file is in is worked out from the level's slot list when you ask for it.
+	///
+	/// Unlike LevelIndex, this can be kept up to date as levels change with updateLevel, instead of being rebuilt from scratch.
+	////////////////////////////////////////////////////////////
+	class GraphicsUsageIndex
+	{
+	public:
+
+		////////////////////////////////////////////////////////////
+		/// \brief How many graphics file numbers are tracked (0 - 0xFFF).  Slots holding anything higher are ignored.
+		////////////////////////////////////////////////////////////
+		static const int fileCount = 0x1000;
+
+		////////////////////////////////////////////////////////////
+		/// \brief One bit per level
+		////////////////////////////////////////////////////////////
+		typedef std::bitset<internal::levelCount> LevelSet;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Creates an empty index.  No level uses any file.
+		////////////////////////////////////////////////////////////
+		GraphicsUsageIndex();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Builds the index from every valid level in a LevelIndex.
+		///
+		/// \param index		The LevelIndex to take the graphics slots from
+		///
+		////////////////////////////////////////////////////////////
+		explicit GraphicsUsageIndex(const LevelIndex &index);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Builds the index from every level in the ROM.  Same as above, but builds the LevelIndex for you.
+		///
+		/// \param romStart		An iterator pointing to the beginning of the ROM data
+		/// \param romEnd		An iterator pointing to the end of the ROM data
+		///
+		////////////////////////////////////////////////////////////
+		template <typename inputIteratorType>
+		GraphicsUsageIndex(inputIteratorType romStart, inputIteratorType romEnd);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Replaces the graphics slots of a single level, updating only the files it used to use and now uses.
+		///
+		/// \param level		The level to update
+		/// \param slots		The level's new slots in the standard order of FG1, FG2, BG1, FG3, BG2, BG3, SP1, SP2, SP3, SP4, AN2
+		///
+		/// \throws std::runtime_error If the level number is out of range
+		///
+		////////////////////////////////////////////////////////////
+		void updateLevel(int level, const std::array<std::uint16_t, 11> &slots);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Re-reads a single level's graphics slots from the ROM (e.g. after its ExGFX bypass entry was changed) and updates the index.
+		/// \details If the level can't be read, it's removed from the index.
+		///
+		/// \param romStart		An iterator pointing to the beginning of the ROM data
+		/// \param romEnd		An iterator pointing to the end of the ROM data
+		/// \param level		The level to update
+		///
+		/// \throws std::runtime_error If the level number is out of range
+		///
+		////////////////////////////////////////////////////////////
+		template <typename inputIteratorType>
+		void updateLevel(inputIteratorType romStart, inputIteratorType romEnd, int level);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Removes a level from the index, so it no longer uses any file.
+		///
+		/// \param level		The level to remove
+		///
+		/// \throws std::runtime_error If the level number is out of range
+		///
+		////////////////////////////////////////////////////////////
+		void removeLevel(int level);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the set of levels that use the specified file in any slot.
+		///
+		/// \param file			The graphics file to look up
+		///
+		/// \throws std::runtime_error If the file number is out of range
+		///
+		////////////////////////////////////////////////////////////
+		const LevelSet &getLevelsUsingGraphicsFile(int file) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Outputs the number of every level that uses the specified file in any slot, in order.
+		///
+		/// \param file			The graphics file to look up
+		/// \param out			Where to output the level numbers
+		///
+		/// \return Iterator pointing to the end of your level list
+		///
+		/// \throws std::runtime_error If the file number is out of range
+		///
+		////////////////////////////////////////////////////////////
+		template <typename outputIteratorType>
+		outputIteratorType findLevelsUsingGraphicsFile(int file, outputIteratorType out) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns which of a level's slots hold the specified file.
+		///
+		/// \param level		The level to check
+		/// \param file			The graphics file to look for
+		///
+		/// \return A mask with bit n set if the file is in slot n (using the values of GFXSlots, so bit 0 is FG1 and bit 10 is AN2).  0 if the level doesn't use the file.
+		///
+		/// \throws std::runtime_error If the level number is out of range
+		///
+		////////////////////////////////////////////////////////////
+		std::uint16_t getSlotsUsingGraphicsFile(int level, int file) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns true if the level uses the specified file in any slot.
+		///
+		/// \throws std::runtime_error If the level number is out of range
+		///
+		////////////////////////////////////////////////////////////
+		bool levelUsesGraphicsFile(int level, int file) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns true if the level is in the index (it was valid when the index was built, or was added with updateLevel).
+		///
+		/// \throws std::runtime_error If the level number is out of range
+		///
+		////////////////////////////////////////////////////////////
+		bool containsLevel(int level) const;
+
+	protected:
+
+		////////////////////////////////////////////////////////////
+		/// \brief Throws if the level is out of range
+		////////////////////////////////////////////////////////////
+		void checkLevel(int level) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Clears the level's bits from every file it currently uses
+		////////////////////////////////////////////////////////////
+		void unlinkLevel(int level);
+
+		////////////////////////////////////////////////////////////
+		/// \brief For each file, the levels that use it
+		////////////////////////////////////////////////////////////
+		std::vector<LevelSet> fileUsage;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The current slots of each level, so the old files can be found when a level changes
+		////////////////////////////////////////////////////////////
+		std::vector<std::array<std::uint16_t, 11>> levelSlots;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The levels that are in the index
+		////////////////////////////////////////////////////////////
+		LevelSet levelsPresent;
+	};
+
+
+//////////////////////////////////////////////////////////////////////////////
+///  @}
+//////////////////////////////////////////////////////////////////////////////
+}
+
+#include "GraphicsUsageIndex.inl"
@@ -0,0 +1,124 @@
+#include "Internal.hpp"
+#include <stdexcept>
+
+namespace worldlib
+{
+	inline GraphicsUsageIndex::GraphicsUsageIndex() : fileUsage(fileCount), levelSlots(internal::levelCount)
+	{
+	}
+
+	inline GraphicsUsageIndex::GraphicsUsageIndex(const LevelIndex &index) : GraphicsUsageIndex()
+	{
+		std::array<std::uint16_t, 11> slots;
+		for (int level = 0; level < index.getLevelCount(); level++)
+		{
+			if (index.isLevelValid(level) == false) continue;
+			index.getGraphicsSlots(level, slots.begin());
+			updateLevel(level, slots);
+		}
+	}
+
+	template <typename inputIteratorType>
+	GraphicsUsageIndex::GraphicsUsageIndex(inputIteratorType romStart, inputIteratorType romEnd) : GraphicsUsageIndex(LevelIndex(romStart, romEnd))
+	{
+	}
+
+	inline void GraphicsUsageIndex::checkLevel(int level) const
+	{
+		if (level < 0 || level >= internal::levelCount)
+			throw std::runtime_error("Level number is out of range.");
+	}
+
+	inline void GraphicsUsageIndex::unlinkLevel(int level)
+	{
+		if (levelsPresent[level] == false) return;
+
+		for (auto file : levelSlots[level])
+			if (file < fileCount)
+				fileUsage[file].reset(level);
+
+		levelsPresent.reset(level);
+	}
+
+	inline void GraphicsUsageIndex::updateLevel(int level, const std::array<std::uint16_t, 11> &slots)
+	{
+		checkLevel(level);
+		unlinkLevel(level);
+
+		levelSlots[level] = slots;
+		for (auto file : slots)
+			if (file < fileCount)
+				fileUsage[file].set(level);
+
+		levelsPresent.set(level);
+	}
+
+	template <typename inputIteratorType>
+	void GraphicsUsageIndex::updateLevel(inputIteratorType romStart, inputIteratorType romEnd, int level)
+	{
+		checkLevel(level);
+
+		LevelGraphicsDescriptor descriptor;
+		try
+		{
+			descriptor = getLevelGraphicsDescriptor(romStart, romEnd, level);
+		}
+		catch (std::runtime_error &)
+		{
+			removeLevel(level);
+			return;
+		}
+
+		updateLevel(level, descriptor.slots);
+	}
+
+	inline void GraphicsUsageIndex::removeLevel(int level)
+	{
+		checkLevel(level);
+		unlinkLevel(level);
+	}
+
+	inline const GraphicsUsageIndex::LevelSet &GraphicsUsageIndex::getLevelsUsingGraphicsFile(int file) const
+	{
+		if (file < 0 || file >= fileCount)
+			throw std::runtime_error("ExGFX file is not valid.");
+		return fileUsage[file];
+	}
+
+	template <typename outputIteratorType>
+	outputIteratorType GraphicsUsageIndex::findLevelsUsingGraphicsFile(int file, outputIteratorType out) const
+	{
+		const auto &levels = getLevelsUsingGraphicsFile(file);
+		if (levels.none()) return out;
+
+		for (int level = 0; level < internal::levelCount; level++)
+			if (levels[level])
+				*(out++) = level;
+		return out;
+	}
+
+	inline std::uint16_t GraphicsUsageIndex::getSlotsUsingGraphicsFile(int level, int file) const
+	{
+		checkLevel(level);
+		if (levelsPresent[level] == false) return 0;
+
+		std::uint16_t mask = 0;
+		for (int i = 0; i < 11; i++)
+			if (levelSlots[level][i] == file)
+				mask |= 1 << i;
+		return mask;
+	}
+
+	inline bool GraphicsUsageIndex::levelUsesGraphicsFile(int level, int file) const
+	{
+		checkLevel(level);
+		if (file < 0 || file >= fileCount) return false;
+		return fileUsage[file][level];
+	}
+
+	inline bool GraphicsUsageIndex::containsLevel(int level) const
+	{
+		checkLevel(level);
+		return levelsPresent[level];
+	}
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+// Define WORLDLIB_INSTRUMENTATION before including world-lib to count and time the library's hot functions.  Without it every hook compiles to nothing, and the snapshot functions always return 0s.
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define WORLDLIB_THREAD_LOCAL __declspec(thread)
+#else
+#define WORLDLIB_THREAD_LOCAL thread_local
+#endif
+
+#ifdef WORLDLIB_INSTRUMENTATION
+#define WORLDLIB_INSTRUMENT(operation) ::worldlib::internal::InstrumentationScope worldlibInstrumentationScope(::worldlib::InstrumentedOperation::operation)
+#define WORLDLIB_COUNT(counter, amount) ::worldlib::internal::addToInstrumentationCounter(::worldlib::InstrumentationCounter::counter, static_cast<std::uint64_t>(amount))
+#else
+#define WORLDLIB_INSTRUMENT(operation) ((void)0)
+#define WORLDLIB_COUNT(counter, amount) ((void)0)
+#endif
+
+namespace worldlib
+{
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file Instrumentation.hpp
+/// \brief Contains optional counters and timers for finding out how much work the library is doing.
+///
+/// \addtogroup Internal
+///  @{
+//////////////////////////////////////////////////////////////////////////////
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief The functions that are counted and timed when WORLDLIB_INSTRUMENTATION is defined
+	////////////////////////////////////////////////////////////
+	enum class InstrumentedOperation : int
+	{
+		SFCToPC = 0,			///< SFCToPC, i.e. every translated read
+		ReadSFC = 1,			///< readByteSFC, readWordSFC, readTrivigintetSFC and readWordsSFC
+		DecompressData = 2,		///< decompressData, which decompressGraphicsFile and composeLevelVRAM go through
+		IndexedImageToBitmap = 3,	///< Every version of indexedImageToBitmap, including indexedImageToBitmapParallel
+		Count = 4			///< Not an operation.  How many there are.
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief Amounts of work added up when WORLDLIB_INSTRUMENTATION is defined
+	////////////////////////////////////////////////////////////
+	enum class InstrumentationCounter : int
+	{
+		BytesReadSFC = 0,		///< Bytes read by the read*SFC functions
+		CompressedBytesRead = 1,	///< Bytes of compressed data read by decompressData
+		BytesDecompressed = 2,		///< Bytes written by decompressData
+		TilesDecoded = 3,		///< 8x8 tiles converted by indexedImageToBitmap
+		ExceptionsThrown = 4,		///< Exceptions that left an instrumented function.  One exception passing through several of them counts once.
+		Count = 5			///< Not a counter.  How many there are.
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief The counters and timers at one point in time.  Returned by getInstrumentationSnapshot and getThreadInstrumentationSnapshot.
+	/// \details Calls and times only include the outermost call of each operation on a thread, so readWordsSFC calling readWordSFC, or indexedImageToBitmap calling itself once per tile, isn't counted twice.
+	/// Times are inclusive:  a readWordSFC call's time includes the SFCToPC call it makes.
+	/// indexedImageToBitmapParallel's helper threads count one call for each band of tiles they decode.
+	////////////////////////////////////////////////////////////
+	struct InstrumentationSnapshot
+	{
+		////////////////////////////////////////////////////////////
+		/// \brief How many times each operation was called.  Index with InstrumentedOperation.
+		////////////////////////////////////////////////////////////
+		std::array<std::uint64_t, (int)InstrumentedOperation::Count> calls;
+
+		////////////////////////////////////////////////////////////
+		/// \brief How long was spent in each operation, in nanoseconds.  Index with InstrumentedOperation.
+		////////////////////////////////////////////////////////////
+		std::array<std::uint64_t, (int)InstrumentedOperation::Count> nanoseconds;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The value of each counter.  Index with InstrumentationCounter.
+		////////////////////////////////////////////////////////////
+		std::array<std::uint64_t, (int)InstrumentationCounter::Count> counters;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Creates a snapshot with everything at 0
+		////////////////////////////////////////////////////////////
+		InstrumentationSnapshot();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns how much everything went up between an earlier snapshot and this one.  Use this to find out what one request cost.
+		////////////////////////////////////////////////////////////
+		InstrumentationSnapshot since(const InstrumentationSnapshot &earlier) const;
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief Returns true if the library was compiled with WORLDLIB_INSTRUMENTATION
+	////////////////////////////////////////////////////////////
+	inline bool isInstrumentationEnabled();
+
+	////////////////////////////////////////////////////////////
+	/// \brief Adds up every thread's counters, including threads that have finished.  Safe to call from any thread at any time, e.g. from a metrics exporter.
+	////////////////////////////////////////////////////////////
+	inline InstrumentationSnapshot getInstrumentationSnapshot();
+
+	////////////////////////////////////////////////////////////
+	/// \brief Returns the calling thread's counters only
+	////////////////////////////////////////////////////////////
+	inline InstrumentationSnapshot getThreadInstrumentationSnapshot();
+
+	////////////////////////////////////////////////////////////
+	/// \brief Returns a short name for an operation (e.g. "SFCToPC"), for labelling exported metrics
+	////////////////////////////////////////////////////////////
+	inline const char *getInstrumentationName(InstrumentedOperation operation);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Returns a short name for a counter (e.g. "bytes_decompressed"), for labelling exported metrics
+	////////////////////////////////////////////////////////////
+	inline const char *getInstrumentationName(InstrumentationCounter counter);
+
+
+//////////////////////////////////////////////////////////////////////////////
+///  @}
+//////////////////////////////////////////////////////////////////////////////
+}
+
+#include "Instrumentation.inl"
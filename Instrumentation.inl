@@ -0,0 +1,199 @@
+#include "Internal.hpp"
+
+#ifdef WORLDLIB_INSTRUMENTATION
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <chrono>
+#include <exception>
+#endif
+
+namespace worldlib
+{
+	inline InstrumentationSnapshot::InstrumentationSnapshot()
+	{
+		calls.fill(0);
+		nanoseconds.fill(0);
+		counters.fill(0);
+	}
+
+	inline InstrumentationSnapshot InstrumentationSnapshot::since(const InstrumentationSnapshot &earlier) const
+	{
+		InstrumentationSnapshot difference;
+		for (std::size_t i = 0; i < calls.size(); i++) difference.calls[i] = calls[i] - earlier.calls[i];
+		for (std::size_t i = 0; i < nanoseconds.size(); i++) difference.nanoseconds[i] = nanoseconds[i] - earlier.nanoseconds[i];
+		for (std::size_t i = 0; i < counters.size(); i++) difference.counters[i] = counters[i] - earlier.counters[i];
+		return difference;
+	}
+
+#ifdef WORLDLIB_INSTRUMENTATION
+	namespace internal
+	{
+		// One thread's counters.  Only the owning thread writes to them, so plain loads and stores are enough, but they're atomic so snapshots can read them from other threads.
+		struct ThreadInstrumentation
+		{
+			std::atomic<std::uint64_t> calls[(int)InstrumentedOperation::Count];
+			std::atomic<std::uint64_t> nanoseconds[(int)InstrumentedOperation::Count];
+			std::atomic<std::uint64_t> counters[(int)InstrumentationCounter::Count];
+			bool active[(int)InstrumentedOperation::Count];		// True while an outermost call of the operation is running
+			int depth;							// How many instrumented calls are running, of any operation
+
+			ThreadInstrumentation() : depth(0)
+			{
+				for (auto &value : calls) value.store(0);
+				for (auto &value : nanoseconds) value.store(0);
+				for (auto &value : counters) value.store(0);
+				for (auto &value : active) value = false;
+			}
+		};
+
+		struct InstrumentationRegistry
+		{
+			std::mutex lock;
+			std::vector<ThreadInstrumentation *> threads;
+		};
+
+		inline InstrumentationRegistry &getInstrumentationRegistry()
+		{
+			static InstrumentationRegistry registry;
+			return registry;
+		}
+
+		// Each thread's counters are made the first time it's instrumented, and never freed, so the totals still include threads that have finished.
+		inline ThreadInstrumentation &getThreadInstrumentation()
+		{
+			static WORLDLIB_THREAD_LOCAL ThreadInstrumentation *instrumentation = nullptr;
+			if (instrumentation == nullptr)
+			{
+				instrumentation = new ThreadInstrumentation;
+				auto &registry = getInstrumentationRegistry();
+				std::lock_guard<std::mutex> lock(registry.lock);
+				registry.threads.push_back(instrumentation);
+			}
+			return *instrumentation;
+		}
+
+		inline void addRelaxed(std::atomic<std::uint64_t> &value, std::uint64_t amount)
+		{
+			value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+		}
+
+		inline void addToInstrumentationCounter(InstrumentationCounter counter, std::uint64_t amount)
+		{
+			addRelaxed(getThreadInstrumentation().counters[(int)counter], amount);
+		}
+
+		// How many exceptions are in flight on this thread.  std::uncaught_exception is deprecated in C++17 and gone in C++20, but it's all VS2013 and pre-C++17 libraries have.
+		inline int getUncaughtExceptionCount()
+		{
+#if defined(__cpp_lib_uncaught_exceptions) || (defined(_MSC_VER) && _MSC_VER >= 1900)
+			return std::uncaught_exceptions();
+#else
+			return std::uncaught_exception() ? 1 : 0;
+#endif
+		}
+
+		// Counts and times an operation for as long as it's in scope.  Nested calls of the same operation don't read the clock at all.
+		class InstrumentationScope
+		{
+		public:
+			explicit InstrumentationScope(InstrumentedOperation operation) : thread(getThreadInstrumentation()), operation((int)operation), outermost(!thread.active[(int)operation]), uncaughtExceptions(getUncaughtExceptionCount())
+			{
+				thread.depth++;
+				if (outermost)
+				{
+					thread.active[this->operation] = true;
+					start = std::chrono::steady_clock::now();
+				}
+			}
+
+			~InstrumentationScope()
+			{
+				thread.depth--;
+				if (outermost)
+				{
+					auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+					addRelaxed(thread.nanoseconds[operation], static_cast<std::uint64_t>(elapsed));
+					addRelaxed(thread.calls[operation], 1);
+					thread.active[operation] = false;
+				}
+				if (thread.depth == 0 && getUncaughtExceptionCount() > uncaughtExceptions)		// An exception is leaving this scope, not just passing by a destructor that called the library
+					addRelaxed(thread.counters[(int)InstrumentationCounter::ExceptionsThrown], 1);
+			}
+
+		private:
+			InstrumentationScope(const InstrumentationScope &);
+			InstrumentationScope &operator=(const InstrumentationScope &);
+
+			ThreadInstrumentation &thread;
+			int operation;
+			bool outermost;
+			int uncaughtExceptions;
+			std::chrono::steady_clock::time_point start;
+		};
+
+		inline InstrumentationSnapshot takeInstrumentationSnapshot(const ThreadInstrumentation &thread, InstrumentationSnapshot snapshot)
+		{
+			for (std::size_t i = 0; i < snapshot.calls.size(); i++) snapshot.calls[i] += thread.calls[i].load(std::memory_order_relaxed);
+			for (std::size_t i = 0; i < snapshot.nanoseconds.size(); i++) snapshot.nanoseconds[i] += thread.nanoseconds[i].load(std::memory_order_relaxed);
+			for (std::size_t i = 0; i < snapshot.counters.size(); i++) snapshot.counters[i] += thread.counters[i].load(std::memory_order_relaxed);
+			return snapshot;
+		}
+	}
+#endif
+
+	inline bool isInstrumentationEnabled()
+	{
+#ifdef WORLDLIB_INSTRUMENTATION
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	inline InstrumentationSnapshot getInstrumentationSnapshot()
+	{
+		InstrumentationSnapshot snapshot;
+#ifdef WORLDLIB_INSTRUMENTATION
+		auto &registry = internal::getInstrumentationRegistry();
+		std::lock_guard<std::mutex> lock(registry.lock);
+		for (auto thread : registry.threads)
+			snapshot = internal::takeInstrumentationSnapshot(*thread, snapshot);
+#endif
+		return snapshot;
+	}
+
+	inline InstrumentationSnapshot getThreadInstrumentationSnapshot()
+	{
+		InstrumentationSnapshot snapshot;
+#ifdef WORLDLIB_INSTRUMENTATION
+		snapshot = internal::takeInstrumentationSnapshot(internal::getThreadInstrumentation(), snapshot);
+#endif
+		return snapshot;
+	}
+
+	inline const char *getInstrumentationName(InstrumentedOperation operation)
+	{
+		switch (operation)
+		{
+		case InstrumentedOperation::SFCToPC:			return "SFCToPC";
+		case InstrumentedOperation::ReadSFC:			return "readSFC";
+		case InstrumentedOperation::DecompressData:		return "decompressData";
+		case InstrumentedOperation::IndexedImageToBitmap:	return "indexedImageToBitmap";
+		default:						return "unknown";
+		}
+	}
+
+	inline const char *getInstrumentationName(InstrumentationCounter counter)
+	{
+		switch (counter)
+		{
+		case InstrumentationCounter::BytesReadSFC:		return "bytes_read_sfc";
+		case InstrumentationCounter::CompressedBytesRead:	return "compressed_bytes_read";
+		case InstrumentationCounter::BytesDecompressed:		return "bytes_decompressed";
+		case InstrumentationCounter::TilesDecoded:		return "tiles_decoded";
+		case InstrumentationCounter::ExceptionsThrown:		return "exceptions_thrown";
+		default:						return "unknown";
+		}
+	}
+}
@@ -58,6 +58,10 @@ namespace worldlib
 		inline std::uint8_t getBit(std::uint8_t number, int bit);
 	}
 
+	// Declared in SFC.hpp.  getLevelHeaderByte uses them, and Internal.inl can be included before SFC.hpp declares them (e.g. through Result.hpp), where two-phase lookup wouldn't find them.
+	template <typename inputIteratorType> std::uint8_t readByteSFC(inputIteratorType romStart, inputIteratorType romEnd, int offset);
+	template <typename inputIteratorType> std::uint32_t readTrivigintetSFC(inputIteratorType romStart, inputIteratorType romEnd, int offset);
+
 
 }
 
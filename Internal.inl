@@ -28,17 +28,26 @@ namespace worldlib
 		// LM-related addresses:
 		const int exgfxBypassListPointerToPointerTable = 0x0FF873;		// Where to find the pointer to the pointers to the ExGFX files list (stored in RATS-protected space). Seems to be tons of other level-related stuff there too?
 		const int exgfxBypassOffset = 0x2D00;					// How far into the table the actual ExGFX list is.  Not an address.
+		const int exgfxBypassEntrySize = 0x20;					// How many bytes each level's entry in the ExGFX list takes up.
+
+		const int levelCount = 0x200;						// How many levels there are in the game.
 
 		// Original SMW-related addresses
 		const int spriteSlotListTableLocation = 0x00A8C3;			// List of the sprite slots levels can use (4 bytes each, 26 slots)
 		const int backgroundSlotListTableLocation = 0x00A92B;			// List of the FG/BG slots levels can use (4 bytes each, 26 slots)
 		const int layer1PointerTableLocation = 0x05E000;			// Pointer to layer 1 data.  Used because the headers contain important information.
+		const int layer2PointerTableLocation = 0x05E600;			// Pointer to layer 2 data (3 bytes each, one per level).
+		const int spritePointerTableLocation = 0x05EC00;			// Low and high bytes of the pointer to each level's sprite data (2 bytes each, one per level).
+		const int spriteDataBankTableLocation = 0x0EF100;			// Bank byte of the pointer to each level's sprite data (1 byte each, one per level).  Always 07 in the original game.
 		
 		const int originalGraphicsFilesLowByteTableLocation = 0x00B992;		// Table of the low bytes of the locations of GFX00 - GFX31
 		const int originalGraphicsFilesHighByteTableLocation = 0x00B9C4;	// Table of the high bytes of the locations of GFX00 - GFX31
 		const int originalGraphicsFilesBankByteTableLocation = 0x00B9F6;	// Table of the bank bytes of the locations of GFX00 - GFX31
 		const int lowExgfxFilesTableLocation = 0x0FF94F;			// Location of the table of the locations of GFX80 - GFXFFF
 
+		const int levelVRAMSlotSize = 0x1000;					// Bytes each graphics slot takes up in composeLevelVRAM's buffer (one 4bpp ExGFX file)
+		const int levelVRAMSize = levelVRAMSlotSize * 11;			// Size of composeLevelVRAM's whole buffer
+
 
 		template <typename inputIteratorType> std::uint8_t getLevelHeaderByte(inputIteratorType romStart, inputIteratorType romEnd, int level, int byteNumber)
 		{
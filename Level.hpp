@@ -1,6 +1,8 @@
 #pragma once
 #include <iterator>
+#include <array>
 #include "ColorBackInserter.hpp"
+#include "Result.hpp"
 
 
 namespace worldlib
@@ -32,6 +34,32 @@ namespace worldlib
 		AN2 = 10 
 	};
 
+	////////////////////////////////////////////////////////////
+	/// \brief Everything about which graphics a level uses, read all at once.  Returned by getLevelGraphicsDescriptor.
+	////////////////////////////////////////////////////////////
+	struct LevelGraphicsDescriptor
+	{
+		////////////////////////////////////////////////////////////
+		/// \brief The graphics file in each of the level's 11 slots.  Index with GFXSlots (e.g. slots[(int)GFXSlots::SP1]).
+		////////////////////////////////////////////////////////////
+		std::array<std::uint16_t, 11> slots;
+
+		////////////////////////////////////////////////////////////
+		/// \brief True if the level bypasses its tilesets' graphics with ExGFX
+		////////////////////////////////////////////////////////////
+		bool usesExGFX;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The level's FG/BG tileset (from the level's header).  Only decides the FG/BG slots if usesExGFX is false.
+		////////////////////////////////////////////////////////////
+		int tileset;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The level's sprite tileset (from the level's header).  Only decides the sprite slots if usesExGFX is false.
+		////////////////////////////////////////////////////////////
+		int spriteTileset;
+	};
+
 	////////////////////////////////////////////////////////////
 	/// \brief Returns the specified level's palette
 	///
@@ -48,6 +76,15 @@ namespace worldlib
 	template <typename inputIteratorType, typename outputIteratorType>
 	outputIteratorType getLevelPalette(inputIteratorType romStart, inputIteratorType romEnd, outputIteratorType out, int level);
 
+	////////////////////////////////////////////////////////////
+	/// \brief Same as getLevelPalette, but returns an error instead of throwing.  Nothing is written to out on failure, and it isn't noexcept because out can throw.
+	///
+	/// \return Iterator pointing to the end of your color data, or an error from tryGetLevelSFCPalette
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType, typename outputIteratorType>
+	Result<outputIteratorType> tryGetLevelPalette(inputIteratorType romStart, inputIteratorType romEnd, outputIteratorType out, int level);
+
 	////////////////////////////////////////////////////////////
 	/// \brief Returns the specified level's background color
 	///
@@ -62,7 +99,74 @@ namespace worldlib
 	////////////////////////////////////////////////////////////
 	template <typename inputIteratorType>
 	std::uint32_t getLevelBackgroundColor(inputIteratorType romStart, inputIteratorType romEnd, int level);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Returns the specified level's palette as raw SFC (15-bit BGR) colors, exactly as they're stored in the ROM.
+	/// \details Use this instead of getLevelPalette if you need to write colors back into a ROM or compare palettes, since converting to ARGB and back with ARGBToSFC isn't guaranteed to give you the same colors.
+	/// getLevelPalette is the same thing passed through SFCToARGB.
+	///
+	/// \param romStart		An iterator pointing to the beginning of the ROM data
+	/// \param romEnd		An iterator pointing to the end of the ROM data
+	/// \param level		The level to get the palette from
+	/// \param backgroundColor	Will contain the level's background color in SFC format after the function ends if it is not nullptr
+	///
+	/// \return The level's 256 colors, minus the BG color
+	///
+	/// \throws std::runtime_error If the ROM did not contain this data (e.g. via invalid pointers or the ROM being cut-off partway through level data or something else weird like that)
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType>
+	std::array<std::uint16_t, 256> getLevelSFCPalette(inputIteratorType romStart, inputIteratorType romEnd, int level, std::uint16_t *backgroundColor = nullptr);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Same as getLevelSFCPalette, but returns an error instead of throwing.  getLevelSFCPalette is a wrapper around this.  backgroundColor is only written if it succeeds.
+	///
+	/// \return The level's 256 colors, minus the BG color, or an error from reading the level's header or palette data (see tryReadByteSFC)
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType>
+	Result<std::array<std::uint16_t, 256>> tryGetLevelSFCPalette(inputIteratorType romStart, inputIteratorType romEnd, int level, std::uint16_t *backgroundColor = nullptr) noexcept;
+
+	////////////////////////////////////////////////////////////
+	/// \brief Returns the specified level's background color as a raw SFC (15-bit BGR) color
+	///
+	/// \param romStart		An iterator pointing to the beginning of the ROM data
+	/// \param romEnd		An iterator pointing to the end of the ROM data
+	/// \param level		The level to get the background color from
+	///
+	/// \return The color, in SFC format
+	///
+	/// \throws std::runtime_error If the ROM did not contain this data (e.g. via invalid pointers or the ROM being cut-off partway through level data or something else weird like that)
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType>
+	std::uint16_t getLevelSFCBackgroundColor(inputIteratorType romStart, inputIteratorType romEnd, int level);
 	
+	////////////////////////////////////////////////////////////
+	/// \brief Returns all of the specified level's graphics information:  its 11 slots, whether it uses ExGFX, and its tilesets.
+	/// \details The other graphics slot functions are all built on this.  If you need more than one of a level's slots, call this once instead of calling them separately.
+	///
+	/// \param romStart		An iterator pointing to the beginning of the ROM data
+	/// \param romEnd		An iterator pointing to the end of the ROM data
+	/// \param level		The level to get the graphics information from
+	///
+	/// \return The level's graphics information
+	///
+	/// \throws std::runtime_error If the ROM did not contain this data (e.g. via invalid pointers or the ROM being cut-off partway through level data or something else weird like that)
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType>
+	LevelGraphicsDescriptor getLevelGraphicsDescriptor(inputIteratorType romStart, inputIteratorType romEnd, int level);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Same as getLevelGraphicsDescriptor, but returns an error instead of throwing.  getLevelGraphicsDescriptor is a wrapper around this.
+	///
+	/// \return The level's graphics information, or an error from reading the level's header or the ExGFX tables (see tryReadByteSFC)
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType>
+	Result<LevelGraphicsDescriptor> tryGetLevelGraphicsDescriptor(inputIteratorType romStart, inputIteratorType romEnd, int level) noexcept;
+
 	////////////////////////////////////////////////////////////
 	/// \brief Returns all 11 of the specified level's graphics slots.
 	/// \details The order is in the standard order of FG1, FG2, BG1, FG3, BG2, BG3, SP1, SP2, SP3, SP4, AN2
@@ -164,6 +268,37 @@ namespace worldlib
 	template <typename inputIteratorType, typename outputIteratorType>
 	outputIteratorType decompressGraphicsFile(inputIteratorType romStart, inputIteratorType romEnd, outputIteratorType out, int file, int *compressedSize = nullptr, int *decompressedSize = nullptr);
 
+	////////////////////////////////////////////////////////////
+	/// \brief Decompresses all of the specified level's graphics slots into one buffer, laid out like the level's VRAM.
+	/// \details The buffer is split into 11 regions of 0x1000 bytes each, one per slot in the standard order of FG1, FG2, BG1, FG3, BG2, BG3, SP1, SP2, SP3, SP4, AN2 (so slot n starts at n * 0x1000), for 0xB000 bytes in total.
+	/// Each different file the level uses is only decompressed once, even if it's in more than one slot, and the files are decompressed on several threads at once, each straight into its own region.
+	/// Files that are exactly 0xC00 bytes are 3bpp, and are expanded to 4bpp like the game does, so every region is 4bpp.
+	/// Slots holding 0x7F are filled with 0s, as is the end of any region whose file is smaller than 0x1000 bytes.  Files larger than 0x1000 bytes are cut off.
+	///
+	/// \param romStart		An iterator pointing to the beginning of the ROM data.  Read from several threads at once.
+	/// \param romEnd		An iterator pointing to the end of the ROM data
+	/// \param level		The level to get the graphics of
+	/// \param buffer		A random access iterator to the start of at least 0xB000 bytes to write to
+	/// \param threadCount		How many threads to use.  If 0 or less, uses std::thread::hardware_concurrency.  Never uses more threads than there are different files.
+	///
+	/// \return Iterator pointing to the end of the level's VRAM data (buffer + 0xB000)
+	///
+	/// \throws std::runtime_error If one of the level's graphics files does not exist or couldn't be decompressed (see decompressGraphicsFile), or if the ROM did not contain the level's data.  If more than one file fails, the error for the earliest slot is the one thrown.
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType, typename randomAccessIteratorType>
+	randomAccessIteratorType composeLevelVRAM(inputIteratorType romStart, inputIteratorType romEnd, int level, randomAccessIteratorType buffer, int threadCount = 0);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Same as composeLevelVRAM, but returns an error instead of throwing for bad ROM data.  composeLevelVRAM is a wrapper around this.
+	/// \details It isn't noexcept, since starting threads and writing to the buffer can still throw.  On failure, the buffer may already have been partly written.
+	///
+	/// \return Iterator pointing to the end of the level's VRAM data (buffer + 0xB000), or an error from tryGetLevelGraphicsDescriptor or tryDecompressGraphicsFile.  If more than one file fails, the error is the earliest slot's.
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType, typename randomAccessIteratorType>
+	Result<randomAccessIteratorType> tryComposeLevelVRAM(inputIteratorType romStart, inputIteratorType romEnd, int level, randomAccessIteratorType buffer, int threadCount = 0);
+
 	////////////////////////////////////////////////////////////
 	/// \brief Gets the address of the specified graphics file.
 	///
@@ -194,6 +329,30 @@ namespace worldlib
 	template <typename inputIteratorType>
 	bool romContainsGraphicsFile(inputIteratorType romStart, inputIteratorType romEnd, int file);
 
+	////////////////////////////////////////////////////////////
+	/// \brief Same as getAddressOfGraphicsFile, but returns an error instead of throwing.  getAddressOfGraphicsFile is a wrapper around this.
+	///
+	/// \return SNES address of the file in the ROM (-1 for file 0x7F), or ErrorCode::InvalidGraphicsFile, ErrorCode::MissingGraphicsFile, or an error from reading the pointer tables (see tryReadByteSFC)
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType>
+	Result<int> tryGetAddressOfGraphicsFile(inputIteratorType romStart, inputIteratorType romEnd, int file) noexcept;
+
+	////////////////////////////////////////////////////////////
+	/// \brief Same as romContainsGraphicsFile, but returns an error instead of throwing.  Only fails if the pointer tables can't be read.
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType>
+	Result<bool> tryROMContainsGraphicsFile(inputIteratorType romStart, inputIteratorType romEnd, int file) noexcept;
+
+	////////////////////////////////////////////////////////////
+	/// \brief Same as decompressGraphicsFile, but returns an error instead of throwing.  Like tryDecompressLZ2, nothing is written to out on failure, and it isn't noexcept because out can throw.
+	///
+	/// \return Iterator pointing to the end of your decompressed image data, or an error from tryGetAddressOfGraphicsFile, trySFCToPC or tryDecompressData.  File 0x7F fails with ErrorCode::UnmappableSFCAddress.
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType, typename outputIteratorType>
+	Result<outputIteratorType> tryDecompressGraphicsFile(inputIteratorType romStart, inputIteratorType romEnd, outputIteratorType out, int file, int *compressedSize = nullptr, int *decompressedSize = nullptr);
+
 
 
 	////////////////////////////////////////////////////////////
@@ -293,6 +452,34 @@ namespace worldlib
 	outputIteratorType indexedImageToBitmap(graphicsInputIteratorType graphicsStart, graphicsInputIteratorType graphicsEnd, paletteInputIteratorType paletteStart, paletteInputIteratorType paletteEnd, int bpp, bool flipX, bool flipY, int paletteNumber, outputIteratorType out);
 
 
+	////////////////////////////////////////////////////////////
+	/// \brief Multi-threaded version of indexedImageToBitmap for large sheets (full 8bpp sheets, whole VRAM dumps, etc.).
+	/// \details The image is split into bands of tile rows, and each thread decodes whole bands into its own part of a shared framebuffer, so the result is always the same as the single-threaded version no matter how the work ends up being scheduled.
+	/// Once every band is done, the framebuffer is sent to out in order, so ColorBackInserter works like it normally does.
+	/// The graphics and palette iterators must be random access, and they're read from several threads at once.
+	/// If the last tile is cut off partway through, the missing bytes are treated as 0.
+	///
+	/// \param graphicsFileStart	An iterator pointing to the start of the graphics file to convert
+	/// \param graphicsFileEnd	An iterator pointing to the end of the graphics file to convert
+	/// \param paletteStart		An iterator pointing to the start of the palette to use in conversion
+	/// \param paletteEnd		An iterator pointing to the end of the palette to use in conversion
+	/// \param tilesInOneRow	How many 8x8 tiles are in one row.  Chances are 0x10 is just fine here.
+	/// \param bpp			The bpp to use for conversion.  Only 2, 4, and 8 are valid.
+	/// \param paletteNumber	The palette number to use for conversion.  If the bpp is 8, this should be 0 unless your palette is for some reason larger than a standard SFC palette
+	/// \param out			Where to send the decoded data.  Highly recommended to use ColorBackInsertIterator to control how the color data is inserted.
+	/// \param resultingWidth	Will contain the width of the image after the function ends if it is not nullptr
+	/// \param resultingHeight	Will contain the height of the image after the function ends if it is not nullptr
+	/// \param threadCount		How many threads to use.  If 0 or less, uses std::thread::hardware_concurrency.  Never uses more threads than there are tile rows.
+	///
+	/// \return Iterator pointing to the end of your converted image data
+	///
+	/// \throws std::runtime_error If the graphics file has a pixel that refers to a palette entry that does not exist.  If more than one band fails, the error from the topmost band is the one thrown.
+	///
+	////////////////////////////////////////////////////////////
+	template <typename graphicsInputIteratorType, typename paletteInputIteratorType, typename outputIteratorType>
+	outputIteratorType indexedImageToBitmapParallel(graphicsInputIteratorType graphicsFileStart, graphicsInputIteratorType graphicsFileEnd, paletteInputIteratorType paletteStart, paletteInputIteratorType paletteEnd, int tilesInOneRow, int bpp, int paletteNumber, outputIteratorType out, int *resultingWidth = nullptr, int *resultingHeight = nullptr, int threadCount = 0);
+
+
 //////////////////////////////////////////////////////////////////////////////
 ///  @}
 //////////////////////////////////////////////////////////////////////////////
@@ -1,87 +1,205 @@
 #include "Internal.hpp"
+#include "Instrumentation.hpp"
+#include "Tracing.hpp"
 #include "Compression.hpp"
+#include <vector>
+#include <array>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <algorithm>
 
 namespace worldlib
 {
 	namespace internal
 	{
 
-		// Returns the level's "standard" palette, regardless of its override settings.
-		template <typename inputIteratorType, typename outputIteratorType>
-		outputIteratorType getLevelStandardPalette(inputIteratorType romStart, inputIteratorType romEnd, outputIteratorType out, int level)
+		// Where a standard palette segment gets its colors from.  The swap palettes depend on the level's header, everything else is at a fixed address.
+		enum class PaletteSource
+		{
+			Fixed,
+			BackgroundSwap,
+			ForegroundSwap,
+			SpriteSwap
+		};
+
+		// One run of colors in the standard palette: count colors starting at (row, column), read from the source's base address + offset.
+		struct PaletteSegment
+		{
+			int row;
+			int column;
+			PaletteSource source;
+			int offset;
+			int count;
+		};
+
+		// The entire layout of a level's standard palette.  Everything not listed here is black, except for color 1 of each row (white).
+		const PaletteSegment standardPaletteLayout[] =
 		{
-			int levelBackgroundIndex = (getLevelHeaderByte(romStart, romEnd, level, 0) & 0xE0) >> 5;
-			int levelForegroundIndex = (getLevelHeaderByte(romStart, romEnd, level, 3) & 0x07) >> 0;
-			int levelSpriteIndex =	   (getLevelHeaderByte(romStart, romEnd, level, 3) & 0x38) >> 3;
+			// Left side of the palette:
 
-			int backgroundSwapPaletteLocation = (sharedBackgroundSwapPalettesLocation + levelBackgroundIndex * 24);
-			int foregroundSwapPaletteLocation = (sharedForegroundSwapPalettesLocation + levelForegroundIndex * 24);
-			int spriteSwapPaletteLocation = (sharedSpriteSwapPalettesLocation + levelSpriteIndex * 24);
+			// The swappable background palettes
+			{ 0x0, 2, PaletteSource::BackgroundSwap, 0 * 12, 6 },
+			{ 0x1, 2, PaletteSource::BackgroundSwap, 1 * 12, 6 },
 
-			std::vector<std::uint32_t> palettes[0x10];
+			// The swappable foreground palettes
+			{ 0x2, 2, PaletteSource::ForegroundSwap, 0 * 12, 6 },
+			{ 0x3, 2, PaletteSource::ForegroundSwap, 1 * 12, 6 },
 
-			// Set everything to black
-			for (int y = 0; y < 16; y++) 
-			{ 
-				palettes[y].resize(16);
-				for (int x = 0; x < 16; x++) palettes[y][x] = 0; 
+			// The constant foreground palettes
+			{ 0x4, 2, PaletteSource::Fixed, sharedForegroundConstPalettesLocation + 0 * 12, 6 },
+			{ 0x5, 2, PaletteSource::Fixed, sharedForegroundConstPalettesLocation + 1 * 12, 6 },
+			{ 0x6, 2, PaletteSource::Fixed, sharedForegroundConstPalettesLocation + 2 * 12, 6 },
+			{ 0x7, 2, PaletteSource::Fixed, sharedForegroundConstPalettesLocation + 3 * 12, 6 },
+
+			// The constant sprite palettes
+			{ 0x8, 2, PaletteSource::Fixed, sharedSpritePaletteLocation + 0 * 12, 6 },
+			{ 0x9, 2, PaletteSource::Fixed, sharedSpritePaletteLocation + 1 * 12, 6 },
+			{ 0xA, 2, PaletteSource::Fixed, sharedSpritePaletteLocation + 2 * 12, 6 },
+			{ 0xB, 2, PaletteSource::Fixed, sharedSpritePaletteLocation + 3 * 12, 6 },
+			{ 0xC, 2, PaletteSource::Fixed, sharedSpritePaletteLocation + 4 * 12, 6 },
+			{ 0xD, 2, PaletteSource::Fixed, sharedSpritePaletteLocation + 5 * 12, 6 },
+
+			// The swappable sprite palettes
+			{ 0xE, 2, PaletteSource::SpriteSwap, 0 * 12, 6 },
+			{ 0xF, 2, PaletteSource::SpriteSwap, 1 * 12, 6 },
+
+
+			// Right side of the palette:
+
+			// The layer 3 palettes
+			{ 0x0, 8, PaletteSource::Fixed, sharedLayer3ConstPalettesLocation + 0 * 16, 8 },
+			{ 0x1, 8, PaletteSource::Fixed, sharedLayer3ConstPalettesLocation + 1 * 16, 8 },
+
+			// The berry palettes
+			{ 0x2, 9, PaletteSource::Fixed, sharedBerryPaletteLocation + 0 * 14, 7 },
+			{ 0x3, 9, PaletteSource::Fixed, sharedBerryPaletteLocation + 1 * 14, 7 },
+			{ 0x4, 9, PaletteSource::Fixed, sharedBerryPaletteLocation + 2 * 14, 7 },
+			{ 0x9, 9, PaletteSource::Fixed, sharedBerryPaletteLocation + 0 * 14, 7 },
+			{ 0xA, 9, PaletteSource::Fixed, sharedBerryPaletteLocation + 1 * 14, 7 },
+			{ 0xB, 9, PaletteSource::Fixed, sharedBerryPaletteLocation + 2 * 14, 7 },
+
+			// Mario's palette
+			{ 0x8, 6, PaletteSource::Fixed, sharedMarioPaletteLocation, 10 },
+		};
+
+
+		// Same as readWordsSFC, but returns an error instead of throwing.  Words before the one that failed may already have been written.
+		template <typename inputIteratorType>
+		ErrorCode tryReadWordsSFC(inputIteratorType romStart, inputIteratorType romEnd, int offset, int count, std::uint16_t *out) noexcept
+		{
+			if (count <= 0) return ErrorCode::None;
+
+			WORLDLIB_INSTRUMENT(ReadSFC);
+			WORLDLIB_COUNT(BytesReadSFC, count * 2);
+
+			auto start = trySFCToPC(romStart, romEnd, offset);
+			if (!start) return start.error();
+			auto end = trySFCToPC(romStart, romEnd, offset + count * 2 - 1);
+			if (!end) return end.error();
+
+			if (end.value() - start.value() != count * 2 - 1)			// Crosses a bank boundary, so every word has to be converted on its own.
+			{
+				for (int i = 0; i < count; i++)
+				{
+					auto address = trySFCToPC(romStart, romEnd, offset + i * 2);
+					if (!address) return address.error();
+					auto word = tryReadWordPC(romStart, romEnd, address.value());
+					if (!word) return word.error();
+					out[i] = word.value();
+				}
+				return ErrorCode::None;
+			}
+
+			if (end.value() >= std::distance(romStart, romEnd))
+				return ErrorCode::AddressOutOfBounds;
+
+			auto current = romStart;
+			std::advance(current, start.value());
+			for (int i = 0; i < count; i++)
+			{
+				std::uint8_t low = *(current++);
+				std::uint8_t high = *(current++);
+				out[i] = static_cast<std::uint16_t>((high << 8) | low);
 			}
+			return ErrorCode::None;
+		}
+
+		// Same as getStandardSFCPalette, but returns an error instead of throwing.
+		template <typename inputIteratorType>
+		ErrorCode tryGetStandardSFCPalette(inputIteratorType romStart, inputIteratorType romEnd, int backgroundIndex, int foregroundIndex, int spriteIndex, std::array<std::uint16_t, 256> &palette) noexcept
+		{
+			int sourceLocations[4];
+			sourceLocations[(int)PaletteSource::Fixed] = 0;
+			sourceLocations[(int)PaletteSource::BackgroundSwap] = sharedBackgroundSwapPalettesLocation + backgroundIndex * 24;
+			sourceLocations[(int)PaletteSource::ForegroundSwap] = sharedForegroundSwapPalettesLocation + foregroundIndex * 24;
+			sourceLocations[(int)PaletteSource::SpriteSwap] = sharedSpriteSwapPalettesLocation + spriteIndex * 24;
+
+			// Set everything to black
+			palette.fill(0);
 
 			// Set up the white colors
-			for (int i = 0; i < 0x08; i++) palettes[i+0][1] = 0xFFE8F0F8;
-			for (int i = 0; i < 0x08; i++) palettes[i+8][1] = 0xFFF8F8F8;
+			for (int i = 0; i < 0x08; i++) palette[(i + 0) * 16 + 1] = 0x7FDD;
+			for (int i = 0; i < 0x08; i++) palette[(i + 8) * 16 + 1] = 0x7FFF;
 
+			for (const auto &segment : standardPaletteLayout)
+			{
+				auto error = tryReadWordsSFC(romStart, romEnd, sourceLocations[(int)segment.source] + segment.offset, segment.count, palette.data() + segment.row * 16 + segment.column);
+				if (error != ErrorCode::None) return error;
+			}
 
-			// Left side of the palette:
+			return ErrorCode::None;
+		}
 
-			// Set up the swappable background palettes
-			for (int x = 2, i = 0; i < 6; x++, i++) palettes[0x0][x] = SFCToARGB(readWordSFC(romStart, romEnd, backgroundSwapPaletteLocation + i * 2 + 0 * 12));
-			for (int x = 2, i = 0; i < 6; x++, i++) palettes[0x1][x] = SFCToARGB(readWordSFC(romStart, romEnd, backgroundSwapPaletteLocation + i * 2 + 1 * 12));
+		// Returns the standard palette made from the given background, foreground and sprite palette numbers (as found in a level's header) as SFC colors.
+		template <typename inputIteratorType>
+		std::array<std::uint16_t, 256> getStandardSFCPalette(inputIteratorType romStart, inputIteratorType romEnd, int backgroundIndex, int foregroundIndex, int spriteIndex)
+		{
+			std::array<std::uint16_t, 256> palette;
+			auto error = tryGetStandardSFCPalette(romStart, romEnd, backgroundIndex, foregroundIndex, spriteIndex, palette);
+			if (error != ErrorCode::None) throwError(error);
+			return palette;
+		}
 
-			// Set up the swappable foreground palettes
-			for (int x = 2, i = 0; i < 6; x++, i++) palettes[0x2][x] = SFCToARGB(readWordSFC(romStart, romEnd, foregroundSwapPaletteLocation + i * 2 + 0 * 12));
-			for (int x = 2, i = 0; i < 6; x++, i++) palettes[0x3][x] = SFCToARGB(readWordSFC(romStart, romEnd, foregroundSwapPaletteLocation + i * 2 + 1 * 12));
 
-			// Set up the constant foreground palettes
-			for (int x = 2, i = 0; i < 6; x++, i++) palettes[0x4][x] = SFCToARGB(readWordSFC(romStart, romEnd, foregroundSwapPaletteLocation + i * 2 + 0 * 12));
-			for (int x = 2, i = 0; i < 6; x++, i++) palettes[0x5][x] = SFCToARGB(readWordSFC(romStart, romEnd, foregroundSwapPaletteLocation + i * 2 + 1 * 12));
-			for (int x = 2, i = 0; i < 6; x++, i++) palettes[0x6][x] = SFCToARGB(readWordSFC(romStart, romEnd, foregroundSwapPaletteLocation + i * 2 + 2 * 12));
-			for (int x = 2, i = 0; i < 6; x++, i++) palettes[0x7][x] = SFCToARGB(readWordSFC(romStart, romEnd, foregroundSwapPaletteLocation + i * 2 + 3 * 12));
+		// Returns the level's "standard" palette as SFC colors, regardless of its override settings.
+		template <typename inputIteratorType>
+		std::array<std::uint16_t, 256> getLevelStandardSFCPalette(inputIteratorType romStart, inputIteratorType romEnd, int level)
+		{
+			std::uint8_t headerByte0 = getLevelHeaderByte(romStart, romEnd, level, 0);
+			std::uint8_t headerByte3 = getLevelHeaderByte(romStart, romEnd, level, 3);
 
-			// Set up the constant sprite palettes
-			for (int x = 2, i = 0; i < 6; x++, i++) palettes[0x8][x] = SFCToARGB(readWordSFC(romStart, romEnd, sharedSpritePaletteLocation + i * 2 + 0 * 12));
-			for (int x = 2, i = 0; i < 6; x++, i++) palettes[0x9][x] = SFCToARGB(readWordSFC(romStart, romEnd, sharedSpritePaletteLocation + i * 2 + 1 * 12));
-			for (int x = 2, i = 0; i < 6; x++, i++) palettes[0xA][x] = SFCToARGB(readWordSFC(romStart, romEnd, sharedSpritePaletteLocation + i * 2 + 2 * 12));
-			for (int x = 2, i = 0; i < 6; x++, i++) palettes[0xB][x] = SFCToARGB(readWordSFC(romStart, romEnd, sharedSpritePaletteLocation + i * 2 + 3 * 12));
-			for (int x = 2, i = 0; i < 6; x++, i++) palettes[0xC][x] = SFCToARGB(readWordSFC(romStart, romEnd, sharedSpritePaletteLocation + i * 2 + 4 * 12));
-			for (int x = 2, i = 0; i < 6; x++, i++) palettes[0xD][x] = SFCToARGB(readWordSFC(romStart, romEnd, sharedSpritePaletteLocation + i * 2 + 5 * 12));
+			int levelBackgroundIndex = (headerByte0 & 0xE0) >> 5;
+			int levelForegroundIndex = (headerByte3 & 0x07) >> 0;
+			int levelSpriteIndex =	   (headerByte3 & 0x38) >> 3;
 
-			// Set up the swappable sprite palettes
-			for (int x = 2, i = 0; i < 6; x++, i++) palettes[0xE][x] = SFCToARGB(readWordSFC(romStart, romEnd, sharedSpriteSwapPalettesLocation + i * 2 + 0 * 12));
-			for (int x = 2, i = 0; i < 6; x++, i++) palettes[0xF][x] = SFCToARGB(readWordSFC(romStart, romEnd, sharedSpriteSwapPalettesLocation + i * 2 + 1 * 12));
+			return getStandardSFCPalette(romStart, romEnd, levelBackgroundIndex, levelForegroundIndex, levelSpriteIndex);
+		}
 
 
-			// Right side of the palette:
+		// Returns the level's custom palette as SFC colors, regardless of its override settings.  If there is no palette, an exception is thrown.
+		template <typename inputIteratorType>
+		std::array<std::uint16_t, 256> getLevelCustomSFCPalette(inputIteratorType romStart, inputIteratorType romEnd, int level)
+		{
+			auto address = readTrivigintetSFC(romStart, romEnd, customPalettePointerTableLocation + level * 3);
+
+			if (address == 0) throw std::runtime_error("Tried to get the custom palette of a level that has none!");
 
-			// Set up the layer 3 palettes
-			for (int x = 8, i = 0; i < 8; x++, i++) palettes[0x0][x] = SFCToARGB(readWordSFC(romStart, romEnd, sharedLayer3ConstPalettesLocation + i * 2 + 0 * 16));
-			for (int x = 8, i = 0; i < 8; x++, i++) palettes[0x1][x] = SFCToARGB(readWordSFC(romStart, romEnd, sharedLayer3ConstPalettesLocation + i * 2 + 1 * 16));
+			address += 2;		// Skip the background color.
 
-			// Set up the berry palettes
-			for (int x = 9, i = 0; i < 7; x++, i++) palettes[0x2][x] = SFCToARGB(readWordSFC(romStart, romEnd, sharedBerryPaletteLocation + i * 2 + 0 * 14));
-			for (int x = 9, i = 0; i < 7; x++, i++) palettes[0x3][x] = SFCToARGB(readWordSFC(romStart, romEnd, sharedBerryPaletteLocation + i * 2 + 1 * 14));
-			for (int x = 9, i = 0; i < 7; x++, i++) palettes[0x4][x] = SFCToARGB(readWordSFC(romStart, romEnd, sharedBerryPaletteLocation + i * 2 + 2 * 14));
-			for (int x = 9, i = 0; i < 7; x++, i++) palettes[0x9][x] = SFCToARGB(readWordSFC(romStart, romEnd, sharedBerryPaletteLocation + i * 2 + 0 * 14));
-			for (int x = 9, i = 0; i < 7; x++, i++) palettes[0xA][x] = SFCToARGB(readWordSFC(romStart, romEnd, sharedBerryPaletteLocation + i * 2 + 1 * 14));
-			for (int x = 9, i = 0; i < 7; x++, i++) palettes[0xB][x] = SFCToARGB(readWordSFC(romStart, romEnd, sharedBerryPaletteLocation + i * 2 + 2 * 14));
+			std::array<std::uint16_t, 256> palette;
+			readWordsSFC(romStart, romEnd, address, 256, palette.begin());
 
-			// Set up Mario's palette
-			for (int x = 6, i = 0; i < 10; x++, i++) palettes[8][x] = SFCToARGB(readWordSFC(romStart, romEnd, sharedMarioPaletteLocation + i * 2 + 0 * 20));
+			return palette;
+		}
 
-			// Finally, output everthing
-			for (int y = 0; y < 16; y++) for (int x = 0; x < 16; x++) *(out++) = palettes[y][x];
 
-			return out;
+		// Returns the level's "standard" palette, regardless of its override settings.
+		template <typename inputIteratorType, typename outputIteratorType>
+		outputIteratorType getLevelStandardPalette(inputIteratorType romStart, inputIteratorType romEnd, outputIteratorType out, int level)
+		{
+			auto palette = getLevelStandardSFCPalette(romStart, romEnd, level);
+			return SFCToARGB(palette.begin(), palette.end(), out);
 		}
 
 
@@ -89,57 +207,186 @@ namespace worldlib
 		template <typename inputIteratorType, typename outputIteratorType>
 		outputIteratorType getLevelCustomPalette(inputIteratorType romStart, inputIteratorType romEnd, outputIteratorType out, int level)
 		{
-			auto address = readTrivigintetSFC(romStart, romEnd, customPalettePointerTableLocation + level * 3);
+			auto palette = getLevelCustomSFCPalette(romStart, romEnd, level);
+			return SFCToARGB(palette.begin(), palette.end(), out);
+		}
+	}
 
-			if (address == 0) throw std::runtime_error("Tried to get the custom palette of a level that has none!");
+	template <typename inputIteratorType>
+	Result<std::array<std::uint16_t, 256>> tryGetLevelSFCPalette(inputIteratorType romStart, inputIteratorType romEnd, int level, std::uint16_t *backgroundColor) noexcept
+	{
+		auto customPaletteAddress = tryReadTrivigintetSFC(romStart, romEnd, internal::customPalettePointerTableLocation + level * 3);
+		if (!customPaletteAddress) return customPaletteAddress.error();
 
-			address += 2;		// Skip the background color.
+		std::array<std::uint16_t, 256> palette;
+		int backgroundColorAddress;
+		ErrorCode error;
+		if (customPaletteAddress.value() == 0)
+		{
+			auto levelAddress = tryReadTrivigintetSFC(romStart, romEnd, internal::layer1PointerTableLocation + level * 3);
+			if (!levelAddress) return levelAddress.error();
 
-			for (int i = 0; i < 512; i+=2)
+			std::uint8_t header[4];
+			for (int i = 0; i < 4; i++)
 			{
-				auto color = readWordSFC(romStart, romEnd, address + i);
-				*(out++) = SFCToARGB(color);
+				auto headerByte = tryReadByteSFC(romStart, romEnd, levelAddress.value() + i);
+				if (!headerByte) return headerByte.error();
+				header[i] = headerByte.value();
 			}
 
-			return out;
+			backgroundColorAddress = internal::sharedBackgroundColorsLocation + internal::getBits(header[1], 0xE0) * 2;
+			error = internal::tryGetStandardSFCPalette(romStart, romEnd, (header[0] & 0xE0) >> 5, (header[3] & 0x07) >> 0, (header[3] & 0x38) >> 3, palette);
+		}
+		else
+		{
+			backgroundColorAddress = customPaletteAddress.value();
+			error = internal::tryReadWordsSFC(romStart, romEnd, customPaletteAddress.value() + 2, 256, palette.data());	// Skip the background color.
+		}
+		if (error != ErrorCode::None) return error;
+
+		if (backgroundColor != nullptr)
+		{
+			auto color = tryReadWordSFC(romStart, romEnd, backgroundColorAddress);
+			if (!color) return color.error();
+			*backgroundColor = color.value();
+		}
+
+		return palette;
+	}
+
+	template <typename inputIteratorType>
+	std::array<std::uint16_t, 256> getLevelSFCPalette(inputIteratorType romStart, inputIteratorType romEnd, int level, std::uint16_t *backgroundColor)
+	{
+		return tryGetLevelSFCPalette(romStart, romEnd, level, backgroundColor).value();
+	}
+
+	template <typename inputIteratorType>
+	std::uint16_t getLevelSFCBackgroundColor(inputIteratorType romStart, inputIteratorType romEnd, int level)
+	{
+		auto address = readTrivigintetSFC(romStart, romEnd, internal::customPalettePointerTableLocation + level * 3);
+
+		if (address == 0)
+		{
+			int index = internal::getBits(internal::getLevelHeaderByte(romStart, romEnd, level, 1), 0xE0);
+			return readWordSFC(romStart, romEnd, internal::sharedBackgroundColorsLocation + index * 2);
+		}
+		else
+		{
+			return readWordSFC(romStart, romEnd, address);
 		}
 	}
 
+	template <typename inputIteratorType, typename outputIteratorType>
+	Result<outputIteratorType> tryGetLevelPalette(inputIteratorType romStart, inputIteratorType romEnd, outputIteratorType out, int level)
+	{
+		WORLDLIB_TRACE_ARG("getLevelPalette", "level", level);
+		auto palette = tryGetLevelSFCPalette(romStart, romEnd, level);
+		if (!palette) return palette.error();
+		return SFCToARGB(palette.value().begin(), palette.value().end(), out);
+	}
+
 	template <typename inputIteratorType, typename outputIteratorType>
 	outputIteratorType getLevelPalette(inputIteratorType romStart, inputIteratorType romEnd, outputIteratorType out, int level)
 	{
-		if (readTrivigintetSFC(romStart, romEnd, internal::customPalettePointerTableLocation + level * 3) == 0)
-			return internal::getLevelStandardPalette(romStart, romEnd, out, level);
-		else
-			return internal::getLevelCustomPalette(romStart, romEnd, out, level);
+		return tryGetLevelPalette(romStart, romEnd, out, level).value();
 	}
 
 
 	template <typename inputIteratorType>
 	std::uint32_t getLevelBackgroundColor(inputIteratorType romStart, inputIteratorType romEnd, int level)
 	{
-		if (readTrivigintetSFC(romStart, romEnd, internal::customPalettePointerTableLocation + level * 3) == 0)
+		return SFCToARGB(getLevelSFCBackgroundColor(romStart, romEnd, level));
+	}
+
+
+	namespace internal
+	{
+		// Same as getLevelGraphicsDescriptor below, but returns an error instead of throwing.
+		template <typename inputIteratorType>
+		ErrorCode tryGetLevelGraphicsDescriptor(inputIteratorType romStart, inputIteratorType romEnd, int bypassEntryAddress, std::uint8_t headerByte2, std::uint8_t headerByte4, LevelGraphicsDescriptor &descriptor) noexcept
 		{
-			auto byte = internal::getLevelHeaderByte(romStart, romEnd, level, 2);
-			internal::getBits(byte, 0xE0);
-			return SFCToARGB(readWordSFC(romStart, romEnd, internal::sharedBackgroundColorsLocation + byte));
+			descriptor.tileset = getBits(headerByte4, 0x0F);
+			descriptor.spriteTileset = getBits(headerByte2, 0x0F);
+
+			// Byte 1's top bit is the ExGFX flag, and the slots are words from 0x06 to 0x1A.
+			std::uint16_t entry[exgfxBypassEntrySize / 2];
+			auto error = tryReadWordsSFC(romStart, romEnd, bypassEntryAddress, exgfxBypassEntrySize / 2, entry);
+			if (error != ErrorCode::None) return error;
+			descriptor.usesExGFX = (entry[0] & 0x8000) == 0x8000;
+
+			if (!descriptor.usesExGFX)
+			{
+				int address = backgroundSlotListTableLocation + descriptor.tileset * 4;
+				for (int i = 0; i < 4; i++)
+				{
+					auto slot = tryReadByteSFC(romStart, romEnd, address + i);
+					if (!slot) return slot.error();
+					descriptor.slots[(int)GFXSlots::FG1 + i] = slot.value();
+				}
+				descriptor.slots[(int)GFXSlots::BG2] = 0x7F;
+				descriptor.slots[(int)GFXSlots::BG3] = 0x7F;
+
+				address = spriteSlotListTableLocation + descriptor.spriteTileset * 4;
+				for (int i = 0; i < 4; i++)
+				{
+					auto slot = tryReadByteSFC(romStart, romEnd, address + i);
+					if (!slot) return slot.error();
+					descriptor.slots[(int)GFXSlots::SP1 + i] = slot.value();
+				}
+
+				descriptor.slots[(int)GFXSlots::AN2] = 0x7F;
+			}
+			else
+			{
+				for (int i = 0; i < 6; i++) descriptor.slots[(int)GFXSlots::FG1 + i] = entry[8 - i];		// FG1 is at 0x10, BG3 is at 0x06
+				for (int i = 0; i < 4; i++) descriptor.slots[(int)GFXSlots::SP1 + i] = entry[12 - i];	// SP1 is at 0x18, SP4 is at 0x12
+				descriptor.slots[(int)GFXSlots::AN2] = entry[13];
+			}
+
+			return ErrorCode::None;
 		}
-		else
-		{
-			auto address = readTrivigintetSFC(romStart, romEnd, internal::customPalettePointerTableLocation + level * 3);
-			if (address == 0) throw std::runtime_error("Tried to get the custom palette of a level that has none!");
 
-			return SFCToARGB(readWordSFC(romStart, romEnd, address));
+		// Builds a level's graphics descriptor from its ExGFX bypass entry (read in one go) and the header bytes that hold its tilesets.
+		template <typename inputIteratorType>
+		LevelGraphicsDescriptor getLevelGraphicsDescriptor(inputIteratorType romStart, inputIteratorType romEnd, int bypassEntryAddress, std::uint8_t headerByte2, std::uint8_t headerByte4)
+		{
+			LevelGraphicsDescriptor descriptor;
+			auto error = tryGetLevelGraphicsDescriptor(romStart, romEnd, bypassEntryAddress, headerByte2, headerByte4, descriptor);
+			if (error != ErrorCode::None) throwError(error);
+			return descriptor;
 		}
 	}
 
+	template <typename inputIteratorType>
+	Result<LevelGraphicsDescriptor> tryGetLevelGraphicsDescriptor(inputIteratorType romStart, inputIteratorType romEnd, int level) noexcept
+	{
+		auto bypassList = tryReadTrivigintetSFC(romStart, romEnd, internal::exgfxBypassListPointerToPointerTable);
+		if (!bypassList) return bypassList.error();
+		auto levelAddress = tryReadTrivigintetSFC(romStart, romEnd, internal::layer1PointerTableLocation + level * 3);
+		if (!levelAddress) return levelAddress.error();
+		auto headerByte2 = tryReadByteSFC(romStart, romEnd, levelAddress.value() + 2);
+		if (!headerByte2) return headerByte2.error();
+		auto headerByte4 = tryReadByteSFC(romStart, romEnd, levelAddress.value() + 4);
+		if (!headerByte4) return headerByte4.error();
+
+		LevelGraphicsDescriptor descriptor;
+		auto error = internal::tryGetLevelGraphicsDescriptor(romStart, romEnd, bypassList.value() + internal::exgfxBypassOffset + level * internal::exgfxBypassEntrySize, headerByte2.value(), headerByte4.value(), descriptor);
+		if (error != ErrorCode::None) return error;
+		return descriptor;
+	}
+
+	template <typename inputIteratorType>
+	LevelGraphicsDescriptor getLevelGraphicsDescriptor(inputIteratorType romStart, inputIteratorType romEnd, int level)
+	{
+		return tryGetLevelGraphicsDescriptor(romStart, romEnd, level).value();
+	}
+
 
 	template <typename inputIteratorType, typename outputIteratorType>
 	outputIteratorType getLevelGraphicsSlots(inputIteratorType romStart, inputIteratorType romEnd, outputIteratorType out, int level)
 	{
-		getLevelBackgroundGraphicsSlots(romStart, romEnd, out, level);
-		getLevelSpriteGraphicsSlots(romStart, romEnd, out, level);
-		*(out++) = getLevelAnimatedTileAreaGraphicsSlot(romStart, romEnd, level);
+		auto descriptor = getLevelGraphicsDescriptor(romStart, romEnd, level);
+		for (int i = (int)GFXSlots::FG1; i <= (int)GFXSlots::AN2; i++) *(out++) = descriptor.slots[i];
 		return out;
 	}
 
@@ -147,129 +394,325 @@ namespace worldlib
 	template <typename inputIteratorType, typename outputIteratorType>
 	outputIteratorType getLevelBackgroundGraphicsSlots(inputIteratorType romStart, inputIteratorType romEnd, outputIteratorType out, int level)
 	{
-		int address = readTrivigintetSFC(romStart, romEnd, internal::exgfxBypassListPointerToPointerTable) + internal::exgfxBypassOffset + level * 0x20;
-		bool usesExGFX = (readByteSFC(romStart, romEnd, address + 1) & 0x80) == 0x80;
-
-		if (!usesExGFX)
-		{
-			int tileset = internal::getBits(internal::getLevelHeaderByte(romStart, romEnd, level, 4), 0x0F);
-			address = internal::backgroundSlotListTableLocation + tileset * 4;
-			*(out++) = readByteSFC(romStart, romEnd, address + 0x00);
-			*(out++) = readByteSFC(romStart, romEnd, address + 0x01);
-			*(out++) = readByteSFC(romStart, romEnd, address + 0x02);
-			*(out++) = readByteSFC(romStart, romEnd, address + 0x03);
-			*(out++) = 0x7F;
-			*(out++) = 0x7F;
-		}
-		else
-		{
-			*(out++) = readWordSFC(romStart, romEnd, address + 0x10);
-			*(out++) = readWordSFC(romStart, romEnd, address + 0x0E);
-			*(out++) = readWordSFC(romStart, romEnd, address + 0x0C);
-			*(out++) = readWordSFC(romStart, romEnd, address + 0x0A);
-			*(out++) = readWordSFC(romStart, romEnd, address + 0x08);
-			*(out++) = readWordSFC(romStart, romEnd, address + 0x06);
-		}
-
+		auto descriptor = getLevelGraphicsDescriptor(romStart, romEnd, level);
+		for (int i = (int)GFXSlots::FG1; i <= (int)GFXSlots::BG3; i++) *(out++) = descriptor.slots[i];
 		return out;
 	}
 
 	template <typename inputIteratorType, typename outputIteratorType>
 	outputIteratorType getLevelSpriteGraphicsSlots(inputIteratorType romStart, inputIteratorType romEnd, outputIteratorType out, int level)
 	{
-		int address = readTrivigintetSFC(romStart, romEnd, internal::exgfxBypassListPointerToPointerTable) + internal::exgfxBypassOffset + level * 0x20;
-		bool usesExGFX = (readByteSFC(romStart, romEnd, address + 1) & 0x80) == 0x80;
-		if (!usesExGFX)
-		{
-			int tileset = internal::getBits(internal::getLevelHeaderByte(romStart, romEnd, level, 4), 0x0F);
-			address = internal::spriteSlotListTableLocation + tileset * 4;
-			*(out++) = readByteSFC(romStart, romEnd, address + 0x00);
-			*(out++) = readByteSFC(romStart, romEnd, address + 0x01);
-			*(out++) = readByteSFC(romStart, romEnd, address + 0x02);
-			*(out++) = readByteSFC(romStart, romEnd, address + 0x03);
-		}
-		else
-		{
-
-			*(out++) = readWordSFC(romStart, romEnd, address + 0x18);
-			*(out++) = readWordSFC(romStart, romEnd, address + 0x16);
-			*(out++) = readWordSFC(romStart, romEnd, address + 0x14);
-			*(out++) = readWordSFC(romStart, romEnd, address + 0x12);
-		}
-
+		auto descriptor = getLevelGraphicsDescriptor(romStart, romEnd, level);
+		for (int i = (int)GFXSlots::SP1; i <= (int)GFXSlots::SP4; i++) *(out++) = descriptor.slots[i];
 		return out;
 	}
 
 	template <typename inputIteratorType>
 	std::uint16_t getLevelAnimatedTileAreaGraphicsSlot(inputIteratorType romStart, inputIteratorType romEnd, int level)
 	{
-		int address = readTrivigintetSFC(romStart, romEnd, internal::exgfxBypassListPointerToPointerTable) + internal::exgfxBypassOffset + level * 0x20;
-		bool usesExGFX = (readByteSFC(romStart, romEnd, address + 1) & 0x80) == 0x80;
-		if (!usesExGFX)
+		return getLevelGraphicsDescriptor(romStart, romEnd, level).slots[(int)GFXSlots::AN2];
+	}
+
+
+	template <typename inputIteratorType>
+	std::uint16_t getLevelSingleGraphicsSlot(inputIteratorType romStart, inputIteratorType romEnd, int level, GFXSlots slotToGet)
+	{
+		return getLevelGraphicsDescriptor(romStart, romEnd, level).slots[(int)slotToGet];
+	}
+
+	namespace internal
+	{
+		// What looking up a graphics file's address found.
+		enum class GraphicsFileStatus
+		{
+			Exists,				// The file's address is valid
+			Placeholder,			// File 0x7F, which isn't a real file
+			Missing,			// The file number is valid, but its pointer is empty
+			InvalidNumber,			// There's no such thing as this file number
+			Unreadable			// The pointer tables couldn't be read.  error says why.
+		};
+
+		// Where the ExGFX pointer tables are.  Read once by readGraphicsFileTables and passed to findGraphicsFile, so looking up many files doesn't follow the same pointers every time.
+		struct GraphicsFileTables
+		{
+			int standardExGFXTable;			// Address of the pointers to ExGFX 80-FF, or -1 if it wasn't read
+			int superExGFXTable;			// Address of the pointers to ExGFX 100-FFF, or -1 if it wasn't read
+			ErrorCode standardExGFXError;		// Why standardExGFXTable couldn't be read, or ErrorCode::None
+			ErrorCode superExGFXError;		// Why superExGFXTable couldn't be read, or ErrorCode::None
+		};
+
+		// Reads the pointers to the ExGFX pointer tables.  Tables that aren't asked for are left at -1.
+		template <typename inputIteratorType>
+		GraphicsFileTables readGraphicsFileTables(inputIteratorType romStart, inputIteratorType romEnd, bool standard = true, bool super = true) noexcept
+		{
+			GraphicsFileTables tables = { -1, -1, ErrorCode::None, ErrorCode::None };
+			if (standard)
+			{
+				auto table = tryReadTrivigintetSFC(romStart, romEnd, standardExGFXPointerToPointerTableLocation);
+				if (table) tables.standardExGFXTable = (int)table.value();
+				else tables.standardExGFXError = table.error();
+			}
+			if (super)
+			{
+				auto table = tryReadTrivigintetSFC(romStart, romEnd, superExGFXPointerToPointerTableLocation);
+				if (table) tables.superExGFXTable = (int)table.value();
+				else tables.superExGFXError = table.error();
+			}
+			return tables;
+		}
+
+		// Looks up a graphics file's address using tables from readGraphicsFileTables.  address is only set if the file exists, and error only if the status is Unreadable.
+		template <typename inputIteratorType>
+		GraphicsFileStatus findGraphicsFile(inputIteratorType romStart, inputIteratorType romEnd, const GraphicsFileTables &tables, int file, int &address, ErrorCode &error) noexcept
 		{
-			return 0x007F;
+			int result = 0;
+			if (file >= 0 && file <= 0x31)
+			{
+				auto low = tryReadByteSFC(romStart, romEnd, originalGraphicsFilesLowByteTableLocation + file);
+				auto high = tryReadByteSFC(romStart, romEnd, originalGraphicsFilesHighByteTableLocation + file);
+				auto bank = tryReadByteSFC(romStart, romEnd, originalGraphicsFilesBankByteTableLocation + file);
+				error = !low ? low.error() : !high ? high.error() : bank.error();
+				if (error != ErrorCode::None) return GraphicsFileStatus::Unreadable;
+				result = low.value() | (high.value() << 8) | (bank.value() << 16);
+			}
+			else if ((file >= 0x80 && file <= 0xFF) || (file >= 0x100 && file <= 0xFFF))
+			{
+				bool standard = file <= 0xFF;
+				error = standard ? tables.standardExGFXError : tables.superExGFXError;
+				if (error != ErrorCode::None) return GraphicsFileStatus::Unreadable;
+
+				auto pointer = tryReadTrivigintetSFC(romStart, romEnd, (standard ? tables.standardExGFXTable : tables.superExGFXTable) + (file - (standard ? 0x80 : 0x100)) * 3);
+				if (!pointer)
+				{
+					error = pointer.error();
+					return GraphicsFileStatus::Unreadable;
+				}
+				result = pointer.value();
+			}
+			else if (file == 0x7F)
+				return GraphicsFileStatus::Placeholder;
+			else
+				return GraphicsFileStatus::InvalidNumber;
+
+			if (result == 0 || result == 0xFFFFFF)
+				return GraphicsFileStatus::Missing;
+
+			address = result;
+			return GraphicsFileStatus::Exists;
 		}
-		else
+
+		// Same as above, but only reads the table the file needs.
+		template <typename inputIteratorType>
+		GraphicsFileStatus findGraphicsFile(inputIteratorType romStart, inputIteratorType romEnd, int file, int &address, ErrorCode &error) noexcept
 		{
-			return readWordSFC(romStart, romEnd, address + 0x1A);
+			return findGraphicsFile(romStart, romEnd, readGraphicsFileTables(romStart, romEnd, file >= 0x80 && file <= 0xFF, file >= 0x100 && file <= 0xFFF), file, address, error);
 		}
 	}
 
-
 	template <typename inputIteratorType>
-	std::uint16_t getLevelSingleGraphicsSlot(inputIteratorType romStart, inputIteratorType romEnd, int level, GFXSlots slotToGet)
+	Result<int> tryGetAddressOfGraphicsFile(inputIteratorType romStart, inputIteratorType romEnd, int file) noexcept
 	{
-		std::vector<std::uint16_t> slots;
-		getLevelGraphicsSlots(romStart, romEnd, std::back_inserter(slots), level);
-		return slots[(int)slotToGet];
+		int address = 0;
+		ErrorCode error = ErrorCode::None;
+		switch (internal::findGraphicsFile(romStart, romEnd, file, address, error))
+		{
+		case internal::GraphicsFileStatus::Placeholder:		return -1;
+		case internal::GraphicsFileStatus::InvalidNumber:	return ErrorCode::InvalidGraphicsFile;
+		case internal::GraphicsFileStatus::Missing:		return ErrorCode::MissingGraphicsFile;
+		case internal::GraphicsFileStatus::Unreadable:		return error;
+		default:						return address;
+		}
 	}
 
 	template <typename inputIteratorType>
 	int getAddressOfGraphicsFile(inputIteratorType romStart, inputIteratorType romEnd, int file)
 	{
-		int address = 0;
-		if (file >= 0 && file <= 0x31)
-			address = readByteSFC(romStart, romEnd, internal::originalGraphicsFilesLowByteTableLocation + file) | (readByteSFC(romStart, romEnd, internal::originalGraphicsFilesHighByteTableLocation + file) << 8) | (readByteSFC(romStart, romEnd, internal::originalGraphicsFilesBankByteTableLocation + file) << 16);
-		else if (file >= 0x80 && file <= 0xFF)
-			address = readTrivigintetSFC(romStart, romEnd, readTrivigintetSFC(romStart, romEnd, internal::standardExGFXPointerToPointerTableLocation) + (file - 0x80) * 3);
-		else if (file >= 0x100 && file <= 0xFFF)
-			address = readTrivigintetSFC(romStart, romEnd, readTrivigintetSFC(romStart, romEnd, internal::superExGFXPointerToPointerTableLocation) + (file - 0x100) * 3);
-		else if (file == 0x7F)
-			return -1;
-		else
-			throw std::runtime_error("ExGFX file is not valid.");
-
-		if (address == 0 || address == 0xFFFFFF)
-			throw std::runtime_error("ExGFX file does not exist.");
+		return tryGetAddressOfGraphicsFile(romStart, romEnd, file).value();
+	}
 
-		return address;
+	template <typename inputIteratorType>
+	Result<bool> tryROMContainsGraphicsFile(inputIteratorType romStart, inputIteratorType romEnd, int file) noexcept
+	{
+		int address = 0;
+		ErrorCode error = ErrorCode::None;
+		auto status = internal::findGraphicsFile(romStart, romEnd, file, address, error);
+		if (status == internal::GraphicsFileStatus::Unreadable) return error;
+		return status == internal::GraphicsFileStatus::Exists || status == internal::GraphicsFileStatus::Placeholder;
 	}
 
 	template <typename inputIteratorType>
 	bool romContainsGraphicsFile(inputIteratorType romStart, inputIteratorType romEnd, int file)
 	{
-		int address = 0;
-		if (file >= 0 && file <= 0x31)
-			address = readByteSFC(romStart, romEnd, internal::originalGraphicsFilesLowByteTableLocation + file) | (readByteSFC(romStart, romEnd, internal::originalGraphicsFilesHighByteTableLocation + file) << 8) | (readByteSFC(romStart, romEnd, internal::originalGraphicsFilesBankByteTableLocation + file) << 16);
-		else if (file >= 0x80 && file <= 0xFF)
-			address = readTrivigintetSFC(romStart, romEnd, readTrivigintetSFC(romStart, romEnd, internal::standardExGFXPointerToPointerTableLocation) + (file - 0x80) * 3);
-		else if (file >= 0x100 && file <= 0xFFF)
-			address = readTrivigintetSFC(romStart, romEnd, readTrivigintetSFC(romStart, romEnd, internal::superExGFXPointerToPointerTableLocation) + (file - 0x100) * 3);
-		else if (file == 0x7F)
-			return true;
-		else
-			return false;
+		return tryROMContainsGraphicsFile(romStart, romEnd, file).value();
+	}
 
-		if (address == 0 || address == 0xFFFFFF)
-			return false;
+	template <typename inputIteratorType, typename outputIteratorType>
+	Result<outputIteratorType> tryDecompressGraphicsFile(inputIteratorType romStart, inputIteratorType romEnd, outputIteratorType out, int file, int *compressedSize, int *decompressedSize)
+	{
+		WORLDLIB_TRACE_ARG("decompressGraphicsFile", "file", file);
+
+		auto address = tryGetAddressOfGraphicsFile(romStart, romEnd, file);
+		if (!address) return address.error();
 
-		return true;
+		auto pcAddress = trySFCToPC(romStart, romEnd, address.value());
+		if (!pcAddress) return pcAddress.error();
+		if (pcAddress.value() >= std::distance(romStart, romEnd)) return ErrorCode::AddressOutOfBounds;
+
+		return tryDecompressData(romStart, romEnd, romStart + pcAddress.value(), romEnd, out, compressedSize, decompressedSize);
 	}
 
 	template <typename inputIteratorType, typename outputIteratorType>
 	outputIteratorType decompressGraphicsFile(inputIteratorType romStart, inputIteratorType romEnd, outputIteratorType out, int file, int *compressedSize, int *decompressedSize)
 	{
-		return decompressData(romStart, romEnd, romStart + SFCToPC(romStart, romEnd, getAddressOfGraphicsFile(romStart, romEnd, file)), romEnd, out, compressedSize, decompressedSize);
+		return tryDecompressGraphicsFile(romStart, romEnd, out, file, compressedSize, decompressedSize).value();
+	}
+
+	namespace internal
+	{
+		// Writes to a fixed-size region and silently drops anything past its end, so a file that's too big can't spill into the next slot.
+		template <typename randomAccessIteratorType>
+		class RegionOutputIterator : std::iterator<std::output_iterator_tag, void, void, void, void>
+		{
+		public:
+			RegionOutputIterator(randomAccessIteratorType start, int size, int *written) : start(start), size(size), written(written) {}
+
+			template <typename valueType>
+			RegionOutputIterator &operator=(const valueType &value)
+			{
+				if (*written < size) start[*written] = static_cast<std::uint8_t>(value);
+				(*written)++;
+				return *this;
+			}
+
+			RegionOutputIterator &operator*() { return *this; }
+			RegionOutputIterator &operator++() { return *this; }
+			RegionOutputIterator operator++(int) { return *this; }
+
+		private:
+			randomAccessIteratorType start;
+			int size;
+			int *written;
+		};
+
+		// Turns 3bpp tiles (24 bytes each) into 4bpp tiles (32 bytes each) in place, the same way the game does when it loads them.
+		template <typename randomAccessIteratorType>
+		void expand3bppTo4bpp(randomAccessIteratorType data, int tileCount)
+		{
+			// Backwards, since each 4bpp tile ends up at or after where its 3bpp version was.
+			for (int tile = tileCount - 1; tile >= 0; tile--)
+			{
+				std::uint8_t source[24];
+				for (int i = 0; i < 24; i++) source[i] = data[tile * 24 + i];
+
+				for (int i = 0; i < 16; i++) data[tile * 32 + i] = source[i];		// Planes 0 and 1 are stored the same way
+				for (int row = 0; row < 8; row++)
+				{
+					data[tile * 32 + 16 + row * 2] = source[16 + row];			// Plane 2
+					data[tile * 32 + 17 + row * 2] = 0;					// Plane 3
+				}
+			}
+		}
+	}
+
+	template <typename inputIteratorType, typename randomAccessIteratorType>
+	Result<randomAccessIteratorType> tryComposeLevelVRAM(inputIteratorType romStart, inputIteratorType romEnd, int level, randomAccessIteratorType buffer, int threadCount)
+	{
+		auto levelDescriptor = tryGetLevelGraphicsDescriptor(romStart, romEnd, level);
+		if (!levelDescriptor) return levelDescriptor.error();
+		const auto &descriptor = levelDescriptor.value();
+
+		// Each different file is decompressed into the first slot that uses it, then copied to any others.
+		int firstSlotUsingFile[11];
+		std::vector<int> slotsToDecompress;
+		for (int slot = 0; slot < 11; slot++)
+		{
+			firstSlotUsingFile[slot] = slot;
+			if (descriptor.slots[slot] == 0x7F) continue;
+
+			for (int other = 0; other < slot; other++)
+			{
+				if (descriptor.slots[other] == descriptor.slots[slot])
+				{
+					firstSlotUsingFile[slot] = other;
+					break;
+				}
+			}
+			if (firstSlotUsingFile[slot] == slot)
+				slotsToDecompress.push_back(slot);
+		}
+
+		int fileCount = (int)slotsToDecompress.size();
+		if (threadCount <= 0) threadCount = (int)std::thread::hardware_concurrency();
+		if (threadCount <= 0) threadCount = 1;
+		threadCount = std::min(threadCount, fileCount);
+
+		std::atomic<int> nextFile(0);
+		std::vector<ErrorCode> fileErrors(fileCount, ErrorCode::None);
+		std::vector<std::exception_ptr> fileExceptions(fileCount);				// Anything that isn't bad ROM data, like running out of memory
+
+		auto worker = [&]()
+		{
+			for (int i = nextFile++; i < fileCount; i = nextFile++)
+			{
+				int slot = slotsToDecompress[i];
+				auto region = buffer + slot * internal::levelVRAMSlotSize;
+				int written = 0;
+				try
+				{
+					auto result = tryDecompressGraphicsFile(romStart, romEnd, internal::RegionOutputIterator<randomAccessIteratorType>(region, internal::levelVRAMSlotSize, &written), descriptor.slots[slot]);
+					if (!result)
+					{
+						fileErrors[i] = result.error();
+						written = 0;
+					}
+				}
+				catch (...)
+				{
+					fileExceptions[i] = std::current_exception();
+					written = 0;
+				}
+				if (written == internal::levelVRAMSlotSize / 4 * 3)				// 0xC00 bytes is a 3bpp file
+				{
+					internal::expand3bppTo4bpp(region, written / 24);
+					written = internal::levelVRAMSlotSize;
+				}
+				if (written < internal::levelVRAMSlotSize)
+					std::fill(region + written, region + internal::levelVRAMSlotSize, 0);
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (int i = 1; i < threadCount; i++)
+			threads.emplace_back(worker);
+		worker();
+		for (auto &t : threads)
+			t.join();
+
+		for (int i = 0; i < fileCount; i++)						// slotsToDecompress is in slot order, so this is the earliest slot's error.
+		{
+			if (fileExceptions[i]) std::rethrow_exception(fileExceptions[i]);
+			if (fileErrors[i] != ErrorCode::None) return fileErrors[i];
+		}
+
+		for (int slot = 0; slot < 11; slot++)
+		{
+			auto region = buffer + slot * internal::levelVRAMSlotSize;
+			if (descriptor.slots[slot] == 0x7F)
+				std::fill(region, region + internal::levelVRAMSlotSize, 0);
+			else if (firstSlotUsingFile[slot] != slot)
+			{
+				auto source = buffer + firstSlotUsingFile[slot] * internal::levelVRAMSlotSize;
+				std::copy(source, source + internal::levelVRAMSlotSize, region);
+			}
+		}
+
+		return buffer + internal::levelVRAMSize;
+	}
+
+	template <typename inputIteratorType, typename randomAccessIteratorType>
+	randomAccessIteratorType composeLevelVRAM(inputIteratorType romStart, inputIteratorType romEnd, int level, randomAccessIteratorType buffer, int threadCount)
+	{
+		return tryComposeLevelVRAM(romStart, romEnd, level, buffer, threadCount).value();
 	}
 
 
@@ -278,12 +721,15 @@ namespace worldlib
 	template <typename graphicsInputIteratorType, typename paletteInputIteratorType, typename outputIteratorType>
 	outputIteratorType indexedImageToBitmap(graphicsInputIteratorType graphicsStart, graphicsInputIteratorType graphicsEnd, paletteInputIteratorType paletteStart, paletteInputIteratorType paletteEnd, int bpp, bool flipX, bool flipY, int paletteNumber, outputIteratorType out)
 	{
+		WORLDLIB_INSTRUMENT(IndexedImageToBitmap);
+
 		auto current = graphicsStart;
 		auto byteCount = std::distance(graphicsStart, graphicsEnd);
 		int bytesPerTile = 8 * bpp;
 		int height = 8;
 		int width = byteCount / bytesPerTile;
 		if (byteCount % bytesPerTile != 0) width++;
+		WORLDLIB_COUNT(TilesDecoded, width);
 		width *= 8;
 		
 		int rowToUse[64] =  { 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7,
@@ -386,6 +832,8 @@ namespace worldlib
 	template <typename graphicsInputIteratorType, typename paletteInputIteratorType, typename outputIteratorType>
 	outputIteratorType indexedImageToBitmap(graphicsInputIteratorType graphicsFileStart, graphicsInputIteratorType graphicsFileEnd, paletteInputIteratorType paletteStart, paletteInputIteratorType paletteEnd, int tilesInOneRow, int bpp, int x, int y, int width, int height, bool flipX, bool flipY, int paletteNumber, outputIteratorType out, int *resultingWidth, int *resultingHeight)
 	{
+		WORLDLIB_INSTRUMENT(IndexedImageToBitmap);
+		WORLDLIB_TRACE("indexedImageToBitmap");
 
 		if (graphicsFileStart == graphicsFileEnd)
 		{
@@ -485,4 +933,114 @@ namespace worldlib
 	{
 		return indexedImageToBitmap(graphicsFileStart, graphicsFileEnd, paletteStart, paletteEnd, 0x10, bpp, paletteNumber, out, resultingWidth, resultingHeight);
 	}
+
+
+	namespace internal
+	{
+		// Decodes tile rows [firstTileRow, lastTileRow) into the framebuffer.  Each tile row only ever touches its own 8 rows of pixels, so bands can be run at the same time.
+		template <typename graphicsInputIteratorType, typename paletteInputIteratorType>
+		void renderTileRowBand(graphicsInputIteratorType graphicsFileStart, int byteCount, paletteInputIteratorType paletteStart, paletteInputIteratorType paletteEnd, int tilesInOneRow, int bpp, int paletteNumber, int firstTileRow, int lastTileRow, std::uint32_t *framebuffer, int framebufferWidth)
+		{
+			WORLDLIB_INSTRUMENT(IndexedImageToBitmap);		// Helper threads count each band as one call
+			WORLDLIB_TRACE_ARG("indexedImageToBitmap band", "firstTileRow", firstTileRow);
+
+			int bytesPerTile = 8 * bpp;
+			int tileCount = (byteCount + bytesPerTile - 1) / bytesPerTile;
+			std::uint8_t paddedTile[64];
+			std::uint32_t tilePixels[64];
+
+			for (int tileY = firstTileRow; tileY < lastTileRow; tileY++)
+			{
+				for (int tileX = 0; tileX < tilesInOneRow; tileX++)
+				{
+					int tile = tileY * tilesInOneRow + tileX;
+					if (tile >= tileCount) return;
+
+					int offset = tile * bytesPerTile;
+					if (offset + bytesPerTile <= byteCount)
+					{
+						indexedImageToBitmap(graphicsFileStart + offset, graphicsFileStart + offset + bytesPerTile, paletteStart, paletteEnd, bpp, false, false, paletteNumber, tilePixels);
+					}
+					else
+					{
+						std::fill(paddedTile, paddedTile + bytesPerTile, 0);
+						std::copy(graphicsFileStart + offset, graphicsFileStart + byteCount, paddedTile);
+						indexedImageToBitmap(paddedTile, paddedTile + bytesPerTile, paletteStart, paletteEnd, bpp, false, false, paletteNumber, tilePixels);
+					}
+
+					for (int subY = 0; subY < 8; subY++)
+						std::copy(tilePixels + subY * 8, tilePixels + subY * 8 + 8, framebuffer + (tileY * 8 + subY) * framebufferWidth + tileX * 8);
+				}
+			}
+		}
+	}
+
+	template <typename graphicsInputIteratorType, typename paletteInputIteratorType, typename outputIteratorType>
+	outputIteratorType indexedImageToBitmapParallel(graphicsInputIteratorType graphicsFileStart, graphicsInputIteratorType graphicsFileEnd, paletteInputIteratorType paletteStart, paletteInputIteratorType paletteEnd, int tilesInOneRow, int bpp, int paletteNumber, outputIteratorType out, int *resultingWidth, int *resultingHeight, int threadCount)
+	{
+		WORLDLIB_INSTRUMENT(IndexedImageToBitmap);
+		WORLDLIB_TRACE("indexedImageToBitmapParallel");
+
+		int byteCount = (int)std::distance(graphicsFileStart, graphicsFileEnd);
+		int bytesPerTile = 8 * bpp;
+		int tileCount = (byteCount + bytesPerTile - 1) / bytesPerTile;
+
+		if (tileCount == 0)
+		{
+			if (resultingHeight != nullptr) *resultingHeight = 0;
+			if (resultingWidth != nullptr) *resultingWidth = 0;
+			return out;
+		}
+
+		int tileRows = (tileCount + tilesInOneRow - 1) / tilesInOneRow;
+		int width = std::min(tileCount, tilesInOneRow) * 8;			// Same as the serial version: the first row decides the width.
+		int height = tileRows * 8;
+
+		std::vector<std::uint32_t> framebuffer(width * height, 0);		// Missing tiles at the end of the last row stay 0, like in the serial version.
+
+		if (threadCount <= 0) threadCount = (int)std::thread::hardware_concurrency();
+		if (threadCount <= 0) threadCount = 1;
+		threadCount = std::min(threadCount, tileRows);
+
+		int tileRowsPerBand = std::max(1, tileRows / (threadCount * 4));	// A few bands per thread so one slow band doesn't hold everyone up.
+		int bandCount = (tileRows + tileRowsPerBand - 1) / tileRowsPerBand;
+
+		std::atomic<int> nextBand(0);
+		std::vector<std::exception_ptr> bandErrors(bandCount);
+
+		auto worker = [&]()
+		{
+			for (int band = nextBand++; band < bandCount; band = nextBand++)
+			{
+				try
+				{
+					int firstTileRow = band * tileRowsPerBand;
+					int lastTileRow = std::min(firstTileRow + tileRowsPerBand, tileRows);
+					internal::renderTileRowBand(graphicsFileStart, byteCount, paletteStart, paletteEnd, tilesInOneRow, bpp, paletteNumber, firstTileRow, lastTileRow, framebuffer.data(), width);
+				}
+				catch (...)
+				{
+					bandErrors[band] = std::current_exception();
+				}
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (int i = 1; i < threadCount; i++)
+			threads.emplace_back(worker);
+		worker();
+		for (auto &t : threads)
+			t.join();
+
+		for (auto &e : bandErrors)
+			if (e) std::rethrow_exception(e);
+
+		for (auto v : framebuffer)
+			*(out++) = v;
+
+		if (resultingHeight != nullptr) *resultingHeight = height;
+		if (resultingWidth != nullptr) *resultingWidth = width;
+
+		return out;
+	}
 }
\ No newline at end of file
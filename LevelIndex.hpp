@@ -0,0 +1,276 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <cstdint>
+#include "Level.hpp"
+
+namespace worldlib
+{
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file LevelIndex.hpp
+/// \brief Contains a class that reads the information for every level in the ROM at once.
+///
+/// \addtogroup Level
+///  @{
+//////////////////////////////////////////////////////////////////////////////
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief Holds the commonly needed information for all 0x200 levels in a ROM, read in one pass.
+	/// \details Every function in Level.hpp looks up the level's pointers again each time it's called, which adds up fast if you're working with every level in the ROM.
+	/// This reads the header bytes, layer pointers, custom palette pointers, ExGFX flags and graphics slots of every level once, so looking them up afterwards is just an array access.
+	/// Each piece of data is stored in its own array (e.g. all levels' SP1 slots are next to each other), so searching every level for something is fast too.
+	///
+	/// The index is a snapshot:  if the ROM changes, you'll need to make a new one.
+	////////////////////////////////////////////////////////////
+	class LevelIndex
+	{
+	public:
+
+		////////////////////////////////////////////////////////////
+		/// \brief Creates an empty index.  Every level is invalid.
+		////////////////////////////////////////////////////////////
+		LevelIndex();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Reads every level in the ROM.
+		/// \details Levels whose data can't be read (e.g. their pointers are invalid) don't cause an exception--they're just marked invalid.  See isLevelValid.
+		///
+		/// \param romStart		An iterator pointing to the beginning of the ROM data
+		/// \param romEnd		An iterator pointing to the end of the ROM data
+		///
+		////////////////////////////////////////////////////////////
+		template <typename inputIteratorType>
+		LevelIndex(inputIteratorType romStart, inputIteratorType romEnd);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns how many levels this index holds (always 0x200).
+		////////////////////////////////////////////////////////////
+		int getLevelCount() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns true if the level's data could be read when the index was built.
+		///
+		/// \param level		The level to check
+		///
+		/// \throws std::runtime_error If the level number is out of range
+		///
+		////////////////////////////////////////////////////////////
+		bool isLevelValid(int level) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the specified header byte from the specified level.  Same as internal::getLevelHeaderByte.
+		///
+		/// \param level		The level to get the header byte from
+		/// \param byteNumber		Which header byte to get (0 - 4)
+		///
+		/// \throws std::runtime_error If the level number or byte number is out of range, or the level is invalid
+		///
+		////////////////////////////////////////////////////////////
+		std::uint8_t getHeaderByte(int level, int byteNumber) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the SNES address of the level's layer 1 data (which starts with its header).
+		///
+		/// \throws std::runtime_error If the level number is out of range, or the level is invalid
+		///
+		////////////////////////////////////////////////////////////
+		int getLayer1Pointer(int level) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the SNES address of the level's layer 2 data.
+		///
+		/// \throws std::runtime_error If the level number is out of range, or the level is invalid
+		///
+		////////////////////////////////////////////////////////////
+		int getLayer2Pointer(int level) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the SNES address of the level's custom palette, or 0 if it doesn't have one.
+		///
+		/// \throws std::runtime_error If the level number is out of range, or the level is invalid
+		///
+		////////////////////////////////////////////////////////////
+		int getCustomPalettePointer(int level) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns true if the level has a custom palette.
+		///
+		/// \throws std::runtime_error If the level number is out of range, or the level is invalid
+		///
+		////////////////////////////////////////////////////////////
+		bool hasCustomPalette(int level) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns true if the level bypasses its tileset's graphics with ExGFX.
+		///
+		/// \throws std::runtime_error If the level number is out of range, or the level is invalid
+		///
+		////////////////////////////////////////////////////////////
+		bool usesExGFX(int level) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the level's FG/BG tileset (the low nibble of header byte 4).
+		///
+		/// \throws std::runtime_error If the level number is out of range, or the level is invalid
+		///
+		////////////////////////////////////////////////////////////
+		int getTileset(int level) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the level's sprite tileset (the low nibble of header byte 2).
+		///
+		/// \throws std::runtime_error If the level number is out of range, or the level is invalid
+		///
+		////////////////////////////////////////////////////////////
+		int getSpriteTileset(int level) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the specified level's specified graphics slot.  Same as getLevelSingleGraphicsSlot.
+		///
+		/// \param level		The level to get the graphics slot from
+		/// \param slotToGet		The level's slot to return
+		///
+		/// \throws std::runtime_error If the level number is out of range, or the level is invalid
+		///
+		////////////////////////////////////////////////////////////
+		std::uint16_t getGraphicsSlot(int level, GFXSlots slotToGet) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns all 11 of the specified level's graphics slots in the standard order of FG1, FG2, BG1, FG3, BG2, BG3, SP1, SP2, SP3, SP4, AN2.  Same as getLevelGraphicsSlots.
+		///
+		/// \param level		The level to get the graphics slots from
+		/// \param out			Where to output the data
+		///
+		/// \return Iterator pointing to the end of your slot list data
+		///
+		/// \throws std::runtime_error If the level number is out of range, or the level is invalid
+		///
+		////////////////////////////////////////////////////////////
+		template <typename outputIteratorType>
+		outputIteratorType getGraphicsSlots(int level, outputIteratorType out) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Outputs the number of every valid level that uses the specified graphics file in any of its slots.
+		///
+		/// \param file			The graphics file to look for
+		/// \param out			Where to output the level numbers
+		///
+		/// \return Iterator pointing to the end of your level list
+		///
+		////////////////////////////////////////////////////////////
+		template <typename outputIteratorType>
+		outputIteratorType findLevelsUsingGraphicsFile(int file, outputIteratorType out) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Outputs the number of every valid level that uses the specified graphics file in the specified slot.
+		///
+		/// \param file			The graphics file to look for
+		/// \param slot			The slot to look in
+		/// \param out			Where to output the level numbers
+		///
+		/// \return Iterator pointing to the end of your level list
+		///
+		////////////////////////////////////////////////////////////
+		template <typename outputIteratorType>
+		outputIteratorType findLevelsUsingGraphicsFile(int file, GFXSlots slot, outputIteratorType out) const;
+
+	protected:
+
+		////////////////////////////////////////////////////////////
+		/// \brief Throws if the level is out of range or couldn't be read
+		////////////////////////////////////////////////////////////
+		void checkLevel(int level) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief 1 for each level that could be read, 0 otherwise
+		////////////////////////////////////////////////////////////
+		std::vector<std::uint8_t> valid;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The 5 header bytes of each level, one array per byte
+		////////////////////////////////////////////////////////////
+		std::vector<std::uint8_t> headerBytes[5];
+
+		////////////////////////////////////////////////////////////
+		/// \brief The SNES address of each level's layer 1 data
+		////////////////////////////////////////////////////////////
+		std::vector<int> layer1Pointers;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The SNES address of each level's layer 2 data
+		////////////////////////////////////////////////////////////
+		std::vector<int> layer2Pointers;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The SNES address of each level's custom palette, or 0
+		////////////////////////////////////////////////////////////
+		std::vector<int> customPalettePointers;
+
+		////////////////////////////////////////////////////////////
+		/// \brief 1 for each level that uses ExGFX, 0 otherwise
+		////////////////////////////////////////////////////////////
+		std::vector<std::uint8_t> exgfxFlags;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The graphics file in each slot of each level, one array per slot (in GFXSlots order)
+		////////////////////////////////////////////////////////////
+		std::vector<std::uint16_t> graphicsSlots[11];
+	};
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief The palettes of every level in the ROM, with duplicates removed.  Returned by getAllLevelPalettes.
+	////////////////////////////////////////////////////////////
+	struct LevelPaletteTable
+	{
+		////////////////////////////////////////////////////////////
+		/// \brief Every distinct palette used by at least one level, as raw SFC colors (minus the BG color, like getLevelSFCPalette)
+		////////////////////////////////////////////////////////////
+		std::vector<std::array<std::uint16_t, 256>> palettes;
+
+		////////////////////////////////////////////////////////////
+		/// \brief For each level, the index of its palette in palettes, or -1 if the level's palette couldn't be read
+		////////////////////////////////////////////////////////////
+		std::vector<int> levelPaletteIndices;
+
+		////////////////////////////////////////////////////////////
+		/// \brief For each level, its background color in SFC format (0 if the level's palette couldn't be read)
+		////////////////////////////////////////////////////////////
+		std::vector<std::uint16_t> levelBackgroundColors;
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief Gets the palette of every level in the ROM at once.
+	/// \details Much faster than calling getLevelSFCPalette for every level:  each combination of standard background, foreground and sprite palettes is only built once, each custom palette is only read once, and levels with identical palettes share one entry in the table.
+	///
+	/// \param romStart		An iterator pointing to the beginning of the ROM data
+	/// \param romEnd		An iterator pointing to the end of the ROM data
+	/// \param index		A LevelIndex built from the same ROM
+	///
+	/// \return The deduplicated palettes, and which one each level uses
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType>
+	LevelPaletteTable getAllLevelPalettes(inputIteratorType romStart, inputIteratorType romEnd, const LevelIndex &index);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Gets the palette of every level in the ROM at once.  Same as above, but builds the LevelIndex for you.
+	///
+	/// \param romStart		An iterator pointing to the beginning of the ROM data
+	/// \param romEnd		An iterator pointing to the end of the ROM data
+	///
+	/// \return The deduplicated palettes, and which one each level uses
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType>
+	LevelPaletteTable getAllLevelPalettes(inputIteratorType romStart, inputIteratorType romEnd);
+
+
+//////////////////////////////////////////////////////////////////////////////
+///  @}
+//////////////////////////////////////////////////////////////////////////////
+}
+
+#include "LevelIndex.inl"
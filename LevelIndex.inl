@@ -0,0 +1,238 @@
+#include "Internal.hpp"
+#include <stdexcept>
+#include <map>
+
+namespace worldlib
+{
+	inline LevelIndex::LevelIndex() : valid(internal::levelCount, 0), layer1Pointers(internal::levelCount, 0), layer2Pointers(internal::levelCount, 0), customPalettePointers(internal::levelCount, 0), exgfxFlags(internal::levelCount, 0)
+	{
+		for (auto &v : headerBytes) v.assign(internal::levelCount, 0);
+		for (auto &v : graphicsSlots) v.assign(internal::levelCount, 0);
+	}
+
+	template <typename inputIteratorType>
+	LevelIndex::LevelIndex(inputIteratorType romStart, inputIteratorType romEnd) : LevelIndex()
+	{
+		bool bypassListValid = true;
+		int bypassListAddress = 0;
+		try
+		{
+			bypassListAddress = readTrivigintetSFC(romStart, romEnd, internal::exgfxBypassListPointerToPointerTable) + internal::exgfxBypassOffset;
+		}
+		catch (std::runtime_error &)
+		{
+			bypassListValid = false;				// Every level's graphics slots depend on this, so no level can be valid.
+		}
+
+		for (int level = 0; level < internal::levelCount && bypassListValid; level++)
+		{
+			try
+			{
+				int layer1 = readTrivigintetSFC(romStart, romEnd, internal::layer1PointerTableLocation + level * 3);
+				std::uint8_t header[5];
+				for (int i = 0; i < 5; i++) header[i] = readByteSFC(romStart, romEnd, layer1 + i);
+
+				int layer2 = readTrivigintetSFC(romStart, romEnd, internal::layer2PointerTableLocation + level * 3);
+				int customPalette = readTrivigintetSFC(romStart, romEnd, internal::customPalettePointerTableLocation + level * 3);
+
+				auto descriptor = internal::getLevelGraphicsDescriptor(romStart, romEnd, bypassListAddress + level * internal::exgfxBypassEntrySize, header[2], header[4]);
+
+				for (int i = 0; i < 5; i++) headerBytes[i][level] = header[i];
+				for (int i = 0; i < 11; i++) graphicsSlots[i][level] = descriptor.slots[i];
+				layer1Pointers[level] = layer1;
+				layer2Pointers[level] = layer2;
+				customPalettePointers[level] = customPalette;
+				exgfxFlags[level] = descriptor.usesExGFX ? 1 : 0;
+				valid[level] = 1;
+			}
+			catch (std::runtime_error &)
+			{
+				valid[level] = 0;
+			}
+		}
+	}
+
+	inline int LevelIndex::getLevelCount() const
+	{
+		return internal::levelCount;
+	}
+
+	inline void LevelIndex::checkLevel(int level) const
+	{
+		if (level < 0 || level >= internal::levelCount)
+			throw std::runtime_error("Level number is out of range.");
+		if (valid[level] == 0)
+			throw std::runtime_error("Level data could not be read from the ROM.");
+	}
+
+	inline bool LevelIndex::isLevelValid(int level) const
+	{
+		if (level < 0 || level >= internal::levelCount)
+			throw std::runtime_error("Level number is out of range.");
+		return valid[level] != 0;
+	}
+
+	inline std::uint8_t LevelIndex::getHeaderByte(int level, int byteNumber) const
+	{
+		checkLevel(level);
+		if (byteNumber < 0 || byteNumber >= 5)
+			throw std::runtime_error("Header byte number is out of range.");
+		return headerBytes[byteNumber][level];
+	}
+
+	inline int LevelIndex::getLayer1Pointer(int level) const
+	{
+		checkLevel(level);
+		return layer1Pointers[level];
+	}
+
+	inline int LevelIndex::getLayer2Pointer(int level) const
+	{
+		checkLevel(level);
+		return layer2Pointers[level];
+	}
+
+	inline int LevelIndex::getCustomPalettePointer(int level) const
+	{
+		checkLevel(level);
+		return customPalettePointers[level];
+	}
+
+	inline bool LevelIndex::hasCustomPalette(int level) const
+	{
+		return getCustomPalettePointer(level) != 0;
+	}
+
+	inline bool LevelIndex::usesExGFX(int level) const
+	{
+		checkLevel(level);
+		return exgfxFlags[level] != 0;
+	}
+
+	inline int LevelIndex::getTileset(int level) const
+	{
+		checkLevel(level);
+		return headerBytes[4][level] & 0x0F;
+	}
+
+	inline int LevelIndex::getSpriteTileset(int level) const
+	{
+		checkLevel(level);
+		return headerBytes[2][level] & 0x0F;
+	}
+
+	inline std::uint16_t LevelIndex::getGraphicsSlot(int level, GFXSlots slotToGet) const
+	{
+		checkLevel(level);
+		return graphicsSlots[(int)slotToGet][level];
+	}
+
+	template <typename outputIteratorType>
+	outputIteratorType LevelIndex::getGraphicsSlots(int level, outputIteratorType out) const
+	{
+		checkLevel(level);
+		for (int i = 0; i < 11; i++)
+			*(out++) = graphicsSlots[i][level];
+		return out;
+	}
+
+	template <typename outputIteratorType>
+	outputIteratorType LevelIndex::findLevelsUsingGraphicsFile(int file, outputIteratorType out) const
+	{
+		for (int level = 0; level < internal::levelCount; level++)
+		{
+			if (valid[level] == 0) continue;
+			for (int i = 0; i < 11; i++)
+			{
+				if (graphicsSlots[i][level] == file)
+				{
+					*(out++) = level;
+					break;
+				}
+			}
+		}
+		return out;
+	}
+
+	template <typename outputIteratorType>
+	outputIteratorType LevelIndex::findLevelsUsingGraphicsFile(int file, GFXSlots slot, outputIteratorType out) const
+	{
+		const auto &slotList = graphicsSlots[(int)slot];
+		for (int level = 0; level < internal::levelCount; level++)
+			if (slotList[level] == file && valid[level] != 0)
+				*(out++) = level;
+		return out;
+	}
+
+	template <typename inputIteratorType>
+	LevelPaletteTable getAllLevelPalettes(inputIteratorType romStart, inputIteratorType romEnd, const LevelIndex &index)
+	{
+		LevelPaletteTable result;
+		result.levelPaletteIndices.assign(index.getLevelCount(), -1);
+		result.levelBackgroundColors.assign(index.getLevelCount(), 0);
+
+		std::map<std::array<std::uint16_t, 256>, int> paletteToIndex;	// So identical palettes (e.g. two levels pointing to copies of the same custom palette) share an entry.
+		std::map<int, int> sourceToIndex;					// Standard palette combination (negative) or custom palette address (positive) to an entry, so nothing is read twice.
+
+		auto addPalette = [&](const std::array<std::uint16_t, 256> &palette) -> int
+		{
+			auto found = paletteToIndex.find(palette);
+			if (found != paletteToIndex.end()) return found->second;
+
+			int newIndex = (int)result.palettes.size();
+			result.palettes.push_back(palette);
+			paletteToIndex[palette] = newIndex;
+			return newIndex;
+		};
+
+		for (int level = 0; level < index.getLevelCount(); level++)
+		{
+			if (index.isLevelValid(level) == false) continue;
+
+			try
+			{
+				int customPalette = index.getCustomPalettePointer(level);
+				int source;
+				std::uint16_t backgroundColor;
+
+				if (customPalette == 0)
+				{
+					int backgroundIndex = (index.getHeaderByte(level, 0) & 0xE0) >> 5;
+					int foregroundIndex = (index.getHeaderByte(level, 3) & 0x07) >> 0;
+					int spriteIndex =     (index.getHeaderByte(level, 3) & 0x38) >> 3;
+					source = -1 - ((backgroundIndex << 6) | (foregroundIndex << 3) | spriteIndex);
+
+					int backgroundColorIndex = internal::getBits(index.getHeaderByte(level, 1), 0xE0);
+					backgroundColor = readWordSFC(romStart, romEnd, internal::sharedBackgroundColorsLocation + backgroundColorIndex * 2);
+
+					if (sourceToIndex.find(source) == sourceToIndex.end())
+						sourceToIndex[source] = addPalette(internal::getStandardSFCPalette(romStart, romEnd, backgroundIndex, foregroundIndex, spriteIndex));
+				}
+				else
+				{
+					source = customPalette;
+					backgroundColor = readWordSFC(romStart, romEnd, customPalette);
+
+					if (sourceToIndex.find(source) == sourceToIndex.end())
+						sourceToIndex[source] = addPalette(internal::getLevelCustomSFCPalette(romStart, romEnd, level));
+				}
+
+				result.levelPaletteIndices[level] = sourceToIndex[source];
+				result.levelBackgroundColors[level] = backgroundColor;
+			}
+			catch (std::runtime_error &)
+			{
+				result.levelPaletteIndices[level] = -1;
+				result.levelBackgroundColors[level] = 0;
+			}
+		}
+
+		return result;
+	}
+
+	template <typename inputIteratorType>
+	LevelPaletteTable getAllLevelPalettes(inputIteratorType romStart, inputIteratorType romEnd)
+	{
+		return getAllLevelPalettes(romStart, romEnd, LevelIndex(romStart, romEnd));
+	}
+}
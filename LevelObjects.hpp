@@ -0,0 +1,190 @@
+#pragma once
+#include <cstdint>
+#include "Level.hpp"
+
+namespace worldlib
+{
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file LevelObjects.hpp
+/// \brief Contains functions for reading a level's layer 1 objects.
+///
+/// \addtogroup Level
+///  @{
+//////////////////////////////////////////////////////////////////////////////
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief The different kinds of entries in a level's object data
+	////////////////////////////////////////////////////////////
+	enum class LevelObjectType : std::uint8_t
+	{
+		Standard,		///< A normal object (01 - 3F), whose third byte is usually its size
+		Extended,		///< Object 00 with an extended object number (02 - FF) in its third byte.  Always a single object with no size.
+		ScreenExit,		///< Extended object 00:  where a screen's exit leads
+		ScreenJump		///< Extended object 01:  moves the following objects to a different screen
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief A single decoded entry from a level's object data.  Plain data, so it's cheap to copy and store in bulk.
+	////////////////////////////////////////////////////////////
+	struct LevelObject
+	{
+		////////////////////////////////////////////////////////////
+		/// \brief What kind of entry this is
+		////////////////////////////////////////////////////////////
+		LevelObjectType type;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The screen the object is on.  For screen exits, the screen the exit belongs to.  For screen jumps, the screen jumped to.
+		////////////////////////////////////////////////////////////
+		std::uint8_t screen;
+
+		////////////////////////////////////////////////////////////
+		/// \brief X position within the screen (0 - F).  For screen exits, the raw flags nibble.
+		////////////////////////////////////////////////////////////
+		std::uint8_t x;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Y position within the screen (0 - 1F)
+		////////////////////////////////////////////////////////////
+		std::uint8_t y;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The object number for standard objects, or the extended object number for everything else
+		////////////////////////////////////////////////////////////
+		std::uint8_t number;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The third byte of standard objects (usually the size:  high nibble is height, low nibble is width).  0 for everything else.
+		////////////////////////////////////////////////////////////
+		std::uint8_t settings;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The bytes after the third one, for entries that are longer than 3 bytes (screen exits, and Lunar Magic's direct Map16 objects)
+		////////////////////////////////////////////////////////////
+		std::uint8_t extra[2];
+
+		////////////////////////////////////////////////////////////
+		/// \brief How many bytes this entry takes up in the object data (3, 4 or 5)
+		////////////////////////////////////////////////////////////
+		std::uint8_t length;
+
+		////////////////////////////////////////////////////////////
+		/// \brief For screen exits, true if the exit uses a secondary exit instead of going straight to a level
+		////////////////////////////////////////////////////////////
+		bool secondaryExit;
+
+		////////////////////////////////////////////////////////////
+		/// \brief For screen exits, the level or secondary exit the exit leads to (0 - 1FF)
+		////////////////////////////////////////////////////////////
+		std::uint16_t destination;
+
+		////////////////////////////////////////////////////////////
+		/// \brief How far into the object data (after the 5 header bytes) this entry starts
+		////////////////////////////////////////////////////////////
+		int offset;
+	};
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief Walks through a level's object data one entry at a time, without allocating anything.
+	/// \details Only moves forward, so it works with any input iterator.  Get one for a level in the ROM with makeLevelObjectReader.
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType>
+	class LevelObjectReader
+	{
+	public:
+
+		////////////////////////////////////////////////////////////
+		/// \brief Starts reading object data.
+		///
+		/// \param objectDataStart	An iterator pointing to the first object (i.e. just after the level's 5 header bytes)
+		/// \param objectDataEnd	An iterator pointing to the end of the object data or any valid point after that (for example, the end of the ROM).
+		///
+		////////////////////////////////////////////////////////////
+		LevelObjectReader(inputIteratorType objectDataStart, inputIteratorType objectDataEnd);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Reads the next entry.
+		///
+		/// \param object		Will contain the entry if there was one
+		///
+		/// \return False if the end of the object data was reached (object is left alone), true otherwise
+		///
+		/// \throws std::runtime_error If the data runs out before the end of the object data is reached
+		///
+		////////////////////////////////////////////////////////////
+		bool next(LevelObject &object);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Skips every entry before the first one on the specified screen or later, so the next call to next returns that entry.
+		/// \details Screen exits count as being wherever they are in the data, not on the screen they belong to.
+		///
+		/// \param screen		The screen to skip to
+		///
+		/// \return False if the end of the object data was reached before getting there, true otherwise
+		///
+		/// \throws std::runtime_error If the data runs out before the end of the object data is reached
+		///
+		////////////////////////////////////////////////////////////
+		bool skipToScreen(int screen);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the screen the reader is on:  the screen of the last entry read, or of the entry skipToScreen stopped at
+		////////////////////////////////////////////////////////////
+		int getCurrentScreen() const;
+
+	private:
+
+		bool decode(LevelObject &object);
+		std::uint8_t readByte();
+
+		inputIteratorType current;
+		inputIteratorType end;
+		int screen;
+		int offset;
+		bool finished;
+		bool hasPending;
+		LevelObject pending;
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief Returns a LevelObjectReader for the specified level's layer 1 objects.
+	/// \details The object data is read straight from the ROM as it's needed, so the ROM data must stay valid while the reader is in use.
+	///
+	/// \param romStart		An iterator pointing to the beginning of the ROM data
+	/// \param romEnd		An iterator pointing to the end of the ROM data
+	/// \param level		The level to read the objects of
+	///
+	/// \return A reader positioned at the level's first object
+	///
+	/// \throws std::runtime_error If the ROM did not contain this data (e.g. via invalid pointers or the ROM being cut-off partway through level data or something else weird like that)
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType>
+	LevelObjectReader<inputIteratorType> makeLevelObjectReader(inputIteratorType romStart, inputIteratorType romEnd, int level);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Outputs every entry in the specified level's layer 1 object data, in order.
+	///
+	/// \param romStart		An iterator pointing to the beginning of the ROM data
+	/// \param romEnd		An iterator pointing to the end of the ROM data
+	/// \param out			Where to output the LevelObjects
+	/// \param level		The level to read the objects of
+	///
+	/// \return Iterator pointing to the end of your object list
+	///
+	/// \throws std::runtime_error If the ROM did not contain this data (e.g. via invalid pointers or the ROM being cut-off partway through level data or something else weird like that)
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType, typename outputIteratorType>
+	outputIteratorType getLevelObjects(inputIteratorType romStart, inputIteratorType romEnd, outputIteratorType out, int level);
+
+
+//////////////////////////////////////////////////////////////////////////////
+///  @}
+//////////////////////////////////////////////////////////////////////////////
+}
+
+#include "LevelObjects.inl"
@@ -0,0 +1,164 @@
+#include "Internal.hpp"
+#include <stdexcept>
+#include <iterator>
+
+namespace worldlib
+{
+	template <typename inputIteratorType>
+	LevelObjectReader<inputIteratorType>::LevelObjectReader(inputIteratorType objectDataStart, inputIteratorType objectDataEnd) : current(objectDataStart), end(objectDataEnd), screen(0), offset(0), finished(false), hasPending(false)
+	{
+	}
+
+	template <typename inputIteratorType>
+	std::uint8_t LevelObjectReader<inputIteratorType>::readByte()
+	{
+		if (current == end)
+			throw std::runtime_error("Level object data ended before its end marker.");
+		std::uint8_t value = static_cast<std::uint8_t>(*current);
+		++current;
+		offset++;
+		return value;
+	}
+
+	template <typename inputIteratorType>
+	bool LevelObjectReader<inputIteratorType>::decode(LevelObject &object)
+	{
+		if (finished) return false;
+
+		int startOffset = offset;
+		std::uint8_t byte1 = readByte();
+		if (byte1 == 0xFF)
+		{
+			finished = true;
+			return false;
+		}
+		std::uint8_t byte2 = readByte();
+		std::uint8_t byte3 = readByte();
+
+		// NBBYYYYY bbbbXXXX SSSSSSSS
+		if (byte1 & 0x80) screen++;
+
+		object.x = byte2 & 0x0F;
+		object.y = byte1 & 0x1F;
+		object.number = ((byte1 & 0x60) >> 1) | (byte2 >> 4);
+		object.settings = 0;
+		object.extra[0] = object.extra[1] = 0;
+		object.length = 3;
+		object.secondaryExit = false;
+		object.destination = 0;
+		object.offset = startOffset;
+
+		if (object.number != 0)
+		{
+			object.type = LevelObjectType::Standard;
+			object.screen = screen;
+			object.settings = byte3;
+
+			// Lunar Magic's direct Map16 objects carry the tile number in extra bytes.
+			if (object.number == 0x22 || object.number == 0x23)
+			{
+				object.extra[0] = readByte();
+				object.length = 4;
+			}
+			if (object.number == 0x23)
+			{
+				object.extra[1] = readByte();
+				object.length = 5;
+			}
+		}
+		else if (byte3 == 0x00)
+		{
+			// 000SSSSS 0000wush 00000000 DDDDDDDD
+			object.type = LevelObjectType::ScreenExit;
+			object.number = 0;
+			object.screen = byte1 & 0x1F;
+			object.extra[0] = readByte();
+			object.length = 4;
+			object.secondaryExit = (byte2 & 0x02) != 0;
+			object.destination = object.extra[0] | ((byte2 & 0x01) << 8);
+		}
+		else if (byte3 == 0x01)
+		{
+			object.type = LevelObjectType::ScreenJump;
+			object.number = 1;
+			screen = byte1 & 0x1F;
+			object.screen = screen;
+		}
+		else
+		{
+			object.type = LevelObjectType::Extended;
+			object.number = byte3;
+			object.screen = screen;
+		}
+
+		return true;
+	}
+
+	template <typename inputIteratorType>
+	bool LevelObjectReader<inputIteratorType>::next(LevelObject &object)
+	{
+		if (hasPending)
+		{
+			object = pending;
+			hasPending = false;
+			return true;
+		}
+		return decode(object);
+	}
+
+	template <typename inputIteratorType>
+	bool LevelObjectReader<inputIteratorType>::skipToScreen(int targetScreen)
+	{
+		if (hasPending && screen >= targetScreen)
+			return true;
+
+		hasPending = false;
+		while (decode(pending))
+		{
+			if (screen >= targetScreen)
+			{
+				hasPending = true;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	template <typename inputIteratorType>
+	int LevelObjectReader<inputIteratorType>::getCurrentScreen() const
+	{
+		return screen;
+	}
+
+	namespace internal
+	{
+		// Object data is the same for layer 1 and layer 2 (when layer 2 is made of objects):  5 header bytes, then the objects.
+		template <typename inputIteratorType>
+		LevelObjectReader<inputIteratorType> makeObjectReaderAt(inputIteratorType romStart, inputIteratorType romEnd, int dataAddress)
+		{
+			int objectDataOffset = SFCToPC(romStart, romEnd, dataAddress + 5);
+			if (objectDataOffset >= std::distance(romStart, romEnd))
+				throw std::runtime_error("Address is out of bounds for the current ROM.");
+
+			auto objectDataStart = romStart;
+			std::advance(objectDataStart, objectDataOffset);
+			return LevelObjectReader<inputIteratorType>(objectDataStart, romEnd);
+		}
+	}
+
+	template <typename inputIteratorType>
+	LevelObjectReader<inputIteratorType> makeLevelObjectReader(inputIteratorType romStart, inputIteratorType romEnd, int level)
+	{
+		return internal::makeObjectReaderAt(romStart, romEnd, readTrivigintetSFC(romStart, romEnd, internal::layer1PointerTableLocation + level * 3));
+	}
+
+	template <typename inputIteratorType, typename outputIteratorType>
+	outputIteratorType getLevelObjects(inputIteratorType romStart, inputIteratorType romEnd, outputIteratorType out, int level)
+	{
+		auto reader = makeLevelObjectReader(romStart, romEnd, level);
+		LevelObject object;
+		while (reader.next(object))
+			*(out++) = object;
+		return out;
+	}
+}
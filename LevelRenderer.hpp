@@ -0,0 +1,284 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include "Level.hpp"
+#include "LevelObjects.hpp"
+#include "Map16.hpp"
+
+namespace worldlib
+{
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file LevelRenderer.hpp
+/// \brief Contains functions for drawing a whole level layer.
+///
+/// \addtogroup Level
+///  @{
+//////////////////////////////////////////////////////////////////////////////
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief A grid of Map16 block numbers covering a whole level layer, one per 16x16 block
+	/// \details Horizontal levels are made of 16x27 block screens side by side.  Vertical levels are made of 32x16 block screens stacked downward.
+	////////////////////////////////////////////////////////////
+	struct LevelTilemap
+	{
+		////////////////////////////////////////////////////////////
+		/// \brief Width in blocks
+		////////////////////////////////////////////////////////////
+		int width;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Height in blocks
+		////////////////////////////////////////////////////////////
+		int height;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The block numbers, one row after another
+		////////////////////////////////////////////////////////////
+		std::vector<std::uint16_t> blocks;
+
+		////////////////////////////////////////////////////////////
+		/// \brief True if the tilemap is laid out as a vertical level
+		////////////////////////////////////////////////////////////
+		bool vertical;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Creates an empty 0x0 tilemap
+		////////////////////////////////////////////////////////////
+		LevelTilemap();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Creates a tilemap filled with one block
+		////////////////////////////////////////////////////////////
+		LevelTilemap(int width, int height, std::uint16_t fillBlock, bool vertical = false);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the block at the specified position
+		///
+		/// \throws std::runtime_error If the position is outside the tilemap
+		///
+		////////////////////////////////////////////////////////////
+		std::uint16_t getBlock(int x, int y) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Sets the block at the specified position.  Positions outside the tilemap are ignored, so objects can hang off the edge.
+		////////////////////////////////////////////////////////////
+		void setBlock(int x, int y, std::uint16_t block);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the block position an object starts at.
+		/// \details In horizontal levels this is (object.screen * 16 + object.x, object.y).
+		/// In vertical levels, bit 4 of object.y picks the left or right half of the screen, so it's ((object.y & 0x10) + object.x, object.screen * 16 + (object.y & 0x0F)).
+		////////////////////////////////////////////////////////////
+		void getObjectPosition(const LevelObject &object, int &x, int &y) const;
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief Places the blocks for a single object into a tilemap.
+	/// \details What each object looks like is decided by the game's code (and any patches in the ROM), not by data, so placing them is up to you.
+	/// Use LevelTilemap::getObjectPosition to find the object's block position, since it depends on whether the level is vertical.  Only standard and extended objects are passed in.
+	////////////////////////////////////////////////////////////
+	typedef std::function<void(const LevelObject &object, LevelTilemap &tilemap)> LevelObjectDrawer;
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief Draws a level layer into a full-size ARGB image and keeps it up to date as the level is edited.
+	/// \details Combines the level's palette (getLevelPalette), its graphics (composeLevelVRAM), Map16 (through a Map16BlockCache) and its object data (LevelObjectReader).
+	/// After the level's objects change, update re-reads them and only redraws the screens whose blocks actually changed.
+	///
+	/// The layout follows the level mode (the low 5 bits of the level's second header byte).  Modes 07, 08, 0A and 0D are vertical:  the image is made of 512x256 screens stacked downward.
+	/// Every other mode is drawn as a horizontal level:  the image is made of 256x432 screens side by side.  Transparent pixels (color 0) have an alpha of 0.
+	////////////////////////////////////////////////////////////
+	class LevelLayerRenderer
+	{
+	public:
+
+		////////////////////////////////////////////////////////////
+		/// \brief Width of one screen of a horizontal level in pixels
+		////////////////////////////////////////////////////////////
+		static const int screenWidth = 16 * 16;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Height of one screen of a horizontal level (and the whole image) in pixels
+		////////////////////////////////////////////////////////////
+		static const int screenHeight = 27 * 16;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Width of one screen of a vertical level (and the whole image) in pixels
+		////////////////////////////////////////////////////////////
+		static const int verticalScreenWidth = 32 * 16;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Height of one screen of a vertical level in pixels
+		////////////////////////////////////////////////////////////
+		static const int verticalScreenHeight = 16 * 16;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The block every position starts out as before objects are placed (an empty block)
+		////////////////////////////////////////////////////////////
+		static const std::uint16_t emptyBlock = 0x25;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Reads the level and draws the whole layer.
+		///
+		/// \param romStart		An iterator pointing to the beginning of the ROM data
+		/// \param romEnd		An iterator pointing to the end of the ROM data
+		/// \param level		The level to draw
+		/// \param layer		The layer to draw (1 or 2).  Layer 2 must be made of objects, not a background tilemap.
+		/// \param map16		Map16 data to look blocks up in.  Must outlive the renderer.
+		/// \param drawer		Places each object's blocks
+		///
+		/// \throws std::runtime_error If the layer isn't 1 or 2, if layer 2 is a background tilemap, if the level's graphics can't be loaded (see composeLevelVRAM), or if the ROM did not contain this data
+		///
+		////////////////////////////////////////////////////////////
+		template <typename inputIteratorType>
+		LevelLayerRenderer(inputIteratorType romStart, inputIteratorType romEnd, int level, int layer, const Map16Table &map16, LevelObjectDrawer drawer);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Re-reads the level's objects after an edit and redraws only the screens whose blocks changed.
+		///
+		/// \param romStart		An iterator pointing to the beginning of the (edited) ROM data
+		/// \param romEnd		An iterator pointing to the end of the ROM data
+		///
+		/// \return How many screens were redrawn
+		///
+		/// \throws std::runtime_error If the ROM did not contain this data
+		///
+		////////////////////////////////////////////////////////////
+		template <typename inputIteratorType>
+		int update(inputIteratorType romStart, inputIteratorType romEnd);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Re-reads the level's palette and graphics (e.g. after an ExGFX file was edited) and redraws every screen.
+		///
+		/// \param romStart		An iterator pointing to the beginning of the (edited) ROM data
+		/// \param romEnd		An iterator pointing to the end of the ROM data
+		///
+		/// \throws std::runtime_error If the level's graphics can't be loaded, or the ROM did not contain this data
+		///
+		////////////////////////////////////////////////////////////
+		template <typename inputIteratorType>
+		void reloadGraphics(inputIteratorType romStart, inputIteratorType romEnd);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Marks a screen to be redrawn by the next call to render.  Screens out of range are ignored.
+		////////////////////////////////////////////////////////////
+		void markScreenDirty(int screen);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Marks every screen to be redrawn by the next call to render
+		////////////////////////////////////////////////////////////
+		void markAllScreensDirty();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns true if the screen is waiting to be redrawn
+		////////////////////////////////////////////////////////////
+		bool isScreenDirty(int screen) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Redraws every dirty screen
+		///
+		/// \return How many screens were redrawn
+		///
+		////////////////////////////////////////////////////////////
+		int render();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns how many screens the level has
+		////////////////////////////////////////////////////////////
+		int getScreenCount() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns true if the level is vertical, so its screens are stacked downward
+		////////////////////////////////////////////////////////////
+		bool isVertical() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the width of the image in pixels
+		////////////////////////////////////////////////////////////
+		int getWidth() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the height of the image in pixels
+		////////////////////////////////////////////////////////////
+		int getHeight() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the image:  ARGB pixels, one row after another
+		////////////////////////////////////////////////////////////
+		const std::vector<std::uint32_t> &getPixels() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the priority bit (0 or 1) of the tile under each pixel, laid out like getPixels.  Pass this to makeCompositorLayer along with the pixels.
+		////////////////////////////////////////////////////////////
+		const std::vector<std::uint8_t> &getPriorities() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the blocks the image was drawn from
+		////////////////////////////////////////////////////////////
+		const LevelTilemap &getTilemap() const;
+
+	protected:
+
+		////////////////////////////////////////////////////////////
+		/// \brief Reads the layer's objects and places them in a fresh tilemap
+		////////////////////////////////////////////////////////////
+		template <typename inputIteratorType>
+		LevelTilemap buildTilemap(inputIteratorType romStart, inputIteratorType romEnd) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Draws one screen's blocks into pixels
+		////////////////////////////////////////////////////////////
+		void drawScreen(int screen);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns where a screen starts in the tilemap, and how many blocks wide and high it is
+		////////////////////////////////////////////////////////////
+		void getScreenBlocks(int screen, int &x, int &y, int &width, int &height) const;
+
+		int level;
+		int layer;
+		int tileset;
+		int screenCount;
+		bool vertical;
+		const Map16Table *map16;
+		LevelObjectDrawer drawer;
+		Map16BlockCache blockCache;
+		std::vector<std::uint8_t> vram;
+		std::vector<std::uint32_t> palette;
+		LevelTilemap tilemap;
+		std::vector<std::uint32_t> pixels;
+		std::vector<std::uint8_t> priorities;
+		std::vector<std::uint8_t> dirtyScreens;
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief Draws a whole level layer once.  See LevelLayerRenderer if you'll be redrawing it after edits.
+	///
+	/// \param romStart		An iterator pointing to the beginning of the ROM data
+	/// \param romEnd		An iterator pointing to the end of the ROM data
+	/// \param level		The level to draw
+	/// \param layer		The layer to draw (1 or 2)
+	/// \param map16		Map16 data to look blocks up in
+	/// \param drawer		Places each object's blocks
+	/// \param out			Where to send the ARGB pixels.  Highly recommended to use ColorBackInsertIterator to control how the color data is inserted.
+	/// \param resultingWidth	Will contain the width of the image after the function ends if it is not nullptr
+	/// \param resultingHeight	Will contain the height of the image after the function ends if it is not nullptr
+	///
+	/// \return Iterator pointing to the end of your image data
+	///
+	/// \throws std::runtime_error See LevelLayerRenderer's constructor
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType, typename outputIteratorType>
+	outputIteratorType renderLevelLayer(inputIteratorType romStart, inputIteratorType romEnd, int level, int layer, const Map16Table &map16, LevelObjectDrawer drawer, outputIteratorType out, int *resultingWidth = nullptr, int *resultingHeight = nullptr);
+
+
+//////////////////////////////////////////////////////////////////////////////
+///  @}
+//////////////////////////////////////////////////////////////////////////////
+}
+
+#include "LevelRenderer.inl"
@@ -0,0 +1,273 @@
+#include "Internal.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <iterator>
+
+namespace worldlib
+{
+	namespace internal
+	{
+		// Level modes 07, 08, 0A and 0D are SMW's vertical levels.
+		inline bool isVerticalLevelMode(int mode)
+		{
+			return mode == 0x07 || mode == 0x08 || mode == 0x0A || mode == 0x0D;
+		}
+	}
+
+	inline LevelTilemap::LevelTilemap() : width(0), height(0), vertical(false)
+	{
+	}
+
+	inline LevelTilemap::LevelTilemap(int width, int height, std::uint16_t fillBlock, bool vertical) : width(width), height(height), blocks(width * height, fillBlock), vertical(vertical)
+	{
+	}
+
+	inline std::uint16_t LevelTilemap::getBlock(int x, int y) const
+	{
+		if (x < 0 || y < 0 || x >= width || y >= height)
+			throw std::runtime_error("Tilemap position is out of range.");
+		return blocks[y * width + x];
+	}
+
+	inline void LevelTilemap::setBlock(int x, int y, std::uint16_t block)
+	{
+		if (x < 0 || y < 0 || x >= width || y >= height) return;
+		blocks[y * width + x] = block;
+	}
+
+	inline void LevelTilemap::getObjectPosition(const LevelObject &object, int &x, int &y) const
+	{
+		if (vertical)
+		{
+			x = (object.y & 0x10) + object.x;
+			y = object.screen * 16 + (object.y & 0x0F);
+		}
+		else
+		{
+			x = object.screen * 16 + object.x;
+			y = object.y;
+		}
+	}
+
+
+
+	template <typename inputIteratorType>
+	LevelLayerRenderer::LevelLayerRenderer(inputIteratorType romStart, inputIteratorType romEnd, int level, int layer, const Map16Table &map16, LevelObjectDrawer drawer) : level(level), layer(layer), map16(&map16), drawer(drawer), blockCache(map16)
+	{
+		if (layer != 1 && layer != 2)
+			throw std::runtime_error("Layer must be 1 or 2.");
+
+		tileset = internal::getLevelHeaderByte(romStart, romEnd, level, 4) & 0x0F;
+		screenCount = (internal::getLevelHeaderByte(romStart, romEnd, level, 0) & 0x1F) + 1;
+		vertical = internal::isVerticalLevelMode(internal::getLevelHeaderByte(romStart, romEnd, level, 1) & 0x1F);
+		pixels.assign(getWidth() * getHeight(), 0);
+		priorities.assign(getWidth() * getHeight(), 0);
+		dirtyScreens.assign(screenCount, 1);
+
+		reloadGraphics(romStart, romEnd);
+		tilemap = buildTilemap(romStart, romEnd);
+		render();
+	}
+
+	template <typename inputIteratorType>
+	LevelTilemap LevelLayerRenderer::buildTilemap(inputIteratorType romStart, inputIteratorType romEnd) const
+	{
+		int dataAddress;
+		if (layer == 1)
+		{
+			dataAddress = readTrivigintetSFC(romStart, romEnd, internal::layer1PointerTableLocation + level * 3);
+		}
+		else
+		{
+			dataAddress = readTrivigintetSFC(romStart, romEnd, internal::layer2PointerTableLocation + level * 3);
+			if ((dataAddress & 0xFF0000) == 0xFF0000)				// The game uses a bank of FF to mean "this is a background tilemap".
+				throw std::runtime_error("Layer 2 of this level is a background, not objects.");
+		}
+
+		LevelTilemap result(getWidth() / 16, getHeight() / 16, emptyBlock, vertical);
+		auto reader = internal::makeObjectReaderAt(romStart, romEnd, dataAddress);
+		LevelObject object;
+		while (reader.next(object))
+		{
+			if (object.type == LevelObjectType::Standard || object.type == LevelObjectType::Extended)
+				drawer(object, result);
+		}
+		return result;
+	}
+
+	inline void LevelLayerRenderer::getScreenBlocks(int screen, int &x, int &y, int &width, int &height) const
+	{
+		if (vertical)
+		{
+			x = 0;
+			y = screen * 16;
+			width = 32;
+			height = 16;
+		}
+		else
+		{
+			x = screen * 16;
+			y = 0;
+			width = 16;
+			height = 27;
+		}
+	}
+
+	inline void LevelLayerRenderer::drawScreen(int screen)
+	{
+		int imageWidth = getWidth();
+		int screenX, screenY, screenBlocksWide, screenBlocksHigh;
+		getScreenBlocks(screen, screenX, screenY, screenBlocksWide, screenBlocksHigh);
+
+		for (int blockY = screenY; blockY < screenY + screenBlocksHigh; blockY++)
+		{
+			for (int blockX = screenX; blockX < screenX + screenBlocksWide; blockX++)
+			{
+				int block = tilemap.getBlock(blockX, blockY);
+				int offset = (blockY * 16) * imageWidth + blockX * 16;
+				auto target = pixels.begin() + offset;
+				auto priorityTarget = priorities.begin() + offset;
+
+				if (map16->hasBlock(tileset, block) == false)
+				{
+					for (int row = 0; row < 16; row++)
+					{
+						std::fill(target + row * imageWidth, target + row * imageWidth + 16, 0);
+						std::fill(priorityTarget + row * imageWidth, priorityTarget + row * imageWidth + 16, 0);
+					}
+					continue;
+				}
+
+				const auto &bitmap = blockCache.getBlock(tileset, block, 0, 0, vram.begin(), vram.end(), palette.begin(), palette.end());		// The cache only ever sees this level's palette and graphics, and is cleared when they're reloaded.
+				for (int row = 0; row < 16; row++)
+					std::copy(bitmap.begin() + row * 16, bitmap.begin() + row * 16 + 16, target + row * imageWidth);
+
+				const Map16Block &map16Block = map16->getBlock(tileset, block);
+				for (int i = 0; i < 4; i++)
+				{
+					auto tileTarget = priorityTarget + ((i & 1) ? 8 : 0) * imageWidth + ((i & 2) ? 8 : 0);
+					std::uint8_t priority = map16Block.tiles[i].getPriority() ? 1 : 0;
+					for (int row = 0; row < 8; row++)
+						std::fill(tileTarget + row * imageWidth, tileTarget + row * imageWidth + 8, priority);
+				}
+			}
+		}
+	}
+
+	inline int LevelLayerRenderer::render()
+	{
+		int drawn = 0;
+		for (int screen = 0; screen < screenCount; screen++)
+		{
+			if (dirtyScreens[screen] == 0) continue;
+			drawScreen(screen);
+			dirtyScreens[screen] = 0;
+			drawn++;
+		}
+		return drawn;
+	}
+
+	template <typename inputIteratorType>
+	int LevelLayerRenderer::update(inputIteratorType romStart, inputIteratorType romEnd)
+	{
+		LevelTilemap newTilemap = buildTilemap(romStart, romEnd);
+
+		// Objects can spill into the screens next to them, so compare the blocks themselves rather than working out which objects changed.
+		for (int screen = 0; screen < screenCount; screen++)
+		{
+			int screenX, screenY, screenBlocksWide, screenBlocksHigh;
+			getScreenBlocks(screen, screenX, screenY, screenBlocksWide, screenBlocksHigh);
+
+			for (int y = screenY; y < screenY + screenBlocksHigh && dirtyScreens[screen] == 0; y++)
+			{
+				auto oldRow = tilemap.blocks.begin() + y * tilemap.width + screenX;
+				auto newRow = newTilemap.blocks.begin() + y * newTilemap.width + screenX;
+				if (std::equal(oldRow, oldRow + screenBlocksWide, newRow) == false)
+					dirtyScreens[screen] = 1;
+			}
+		}
+
+		tilemap = newTilemap;
+		return render();
+	}
+
+	template <typename inputIteratorType>
+	void LevelLayerRenderer::reloadGraphics(inputIteratorType romStart, inputIteratorType romEnd)
+	{
+		vram.assign(internal::levelVRAMSize, 0);
+		composeLevelVRAM(romStart, romEnd, level, vram.begin());
+
+		palette.clear();
+		getLevelPalette(romStart, romEnd, std::back_inserter(palette), level);
+
+		blockCache.clear();
+		markAllScreensDirty();
+		if (tilemap.width != 0) render();
+	}
+
+	inline void LevelLayerRenderer::markScreenDirty(int screen)
+	{
+		if (screen < 0 || screen >= screenCount) return;
+		dirtyScreens[screen] = 1;
+	}
+
+	inline void LevelLayerRenderer::markAllScreensDirty()
+	{
+		std::fill(dirtyScreens.begin(), dirtyScreens.end(), 1);
+	}
+
+	inline bool LevelLayerRenderer::isScreenDirty(int screen) const
+	{
+		if (screen < 0 || screen >= screenCount) return false;
+		return dirtyScreens[screen] != 0;
+	}
+
+	inline int LevelLayerRenderer::getScreenCount() const
+	{
+		return screenCount;
+	}
+
+	inline bool LevelLayerRenderer::isVertical() const
+	{
+		return vertical;
+	}
+
+	inline int LevelLayerRenderer::getWidth() const
+	{
+		return vertical ? verticalScreenWidth : screenCount * screenWidth;
+	}
+
+	inline int LevelLayerRenderer::getHeight() const
+	{
+		return vertical ? screenCount * verticalScreenHeight : screenHeight;
+	}
+
+	inline const std::vector<std::uint32_t> &LevelLayerRenderer::getPixels() const
+	{
+		return pixels;
+	}
+
+	inline const std::vector<std::uint8_t> &LevelLayerRenderer::getPriorities() const
+	{
+		return priorities;
+	}
+
+	inline const LevelTilemap &LevelLayerRenderer::getTilemap() const
+	{
+		return tilemap;
+	}
+
+	template <typename inputIteratorType, typename outputIteratorType>
+	outputIteratorType renderLevelLayer(inputIteratorType romStart, inputIteratorType romEnd, int level, int layer, const Map16Table &map16, LevelObjectDrawer drawer, outputIteratorType out, int *resultingWidth, int *resultingHeight)
+	{
+		LevelLayerRenderer renderer(romStart, romEnd, level, layer, map16, drawer);
+
+		for (auto v : renderer.getPixels())
+			*(out++) = v;
+
+		if (resultingWidth != nullptr) *resultingWidth = renderer.getWidth();
+		if (resultingHeight != nullptr) *resultingHeight = renderer.getHeight();
+
+		return out;
+	}
+}
@@ -0,0 +1,189 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <cstdint>
+#include "Level.hpp"
+
+namespace worldlib
+{
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file LevelSprites.hpp
+/// \brief Contains functions for reading a level's sprite data.
+///
+/// \addtogroup Level
+///  @{
+//////////////////////////////////////////////////////////////////////////////
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief A single sprite from a level's sprite data.  Plain data, 8 bytes.
+	////////////////////////////////////////////////////////////
+	struct LevelSprite
+	{
+		////////////////////////////////////////////////////////////
+		/// \brief The screen the sprite is on (0 - 1F)
+		////////////////////////////////////////////////////////////
+		std::uint8_t screen;
+
+		////////////////////////////////////////////////////////////
+		/// \brief X position within the screen, in 16x16 blocks (0 - F)
+		////////////////////////////////////////////////////////////
+		std::uint8_t x;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Y position, in 16x16 blocks (0 - 1F)
+		////////////////////////////////////////////////////////////
+		std::uint8_t y;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The sprite's extra bits (0 - 3)
+		////////////////////////////////////////////////////////////
+		std::uint8_t extraBits;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The sprite number
+		////////////////////////////////////////////////////////////
+		std::uint8_t number;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Unused.  Keeps the struct at 8 bytes.
+		////////////////////////////////////////////////////////////
+		std::uint8_t padding;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The sprite's position in the level's sprite data (0 for the first sprite, 1 for the second and so on)
+		////////////////////////////////////////////////////////////
+		std::uint16_t index;
+	};
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief A level's sprite header and sprites, indexed by screen.
+	/// \details The sprites are read once and stored in screen order along with where each screen starts, so getting the sprites on one screen doesn't need to look at any other screen.
+	/// The game expects sprite data to already be in screen order, so normally they're stored exactly as they are in the ROM.  If they aren't, they're sorted by screen (keeping their order otherwise), and LevelSprite::index still tells you where each one was.
+	///
+	/// Only the standard 3-byte sprite format is supported.
+	////////////////////////////////////////////////////////////
+	class LevelSpriteList
+	{
+	public:
+
+		////////////////////////////////////////////////////////////
+		/// \brief How many screens a level can have
+		////////////////////////////////////////////////////////////
+		static const int screenCount = 0x20;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Creates an empty list with no sprites
+		////////////////////////////////////////////////////////////
+		LevelSpriteList();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Reads the specified level's sprite data.
+		///
+		/// \param romStart		An iterator pointing to the beginning of the ROM data
+		/// \param romEnd		An iterator pointing to the end of the ROM data
+		/// \param level		The level to read the sprites of
+		///
+		/// \throws std::runtime_error If the ROM did not contain this data (e.g. via invalid pointers or the ROM being cut-off partway through sprite data or something else weird like that)
+		///
+		////////////////////////////////////////////////////////////
+		template <typename inputIteratorType>
+		LevelSpriteList(inputIteratorType romStart, inputIteratorType romEnd, int level);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the sprite header byte
+		////////////////////////////////////////////////////////////
+		std::uint8_t getHeader() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the level's sprite memory setting (the low 6 bits of the header)
+		////////////////////////////////////////////////////////////
+		int getSpriteMemorySetting() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns true if the level's sprite buoyancy is enabled (the highest bit of the header)
+		////////////////////////////////////////////////////////////
+		bool hasBuoyancy() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns how many sprites the level has
+		////////////////////////////////////////////////////////////
+		int getSpriteCount() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns every sprite, in screen order
+		////////////////////////////////////////////////////////////
+		const std::vector<LevelSprite> &getSprites() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns how many sprites are on the specified screen
+		///
+		/// \throws std::runtime_error If the screen number is out of range
+		///
+		////////////////////////////////////////////////////////////
+		int getScreenSpriteCount(int screen) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns an iterator to the first sprite on the specified screen
+		///
+		/// \throws std::runtime_error If the screen number is out of range
+		///
+		////////////////////////////////////////////////////////////
+		std::vector<LevelSprite>::const_iterator screenBegin(int screen) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns an iterator to just after the last sprite on the specified screen
+		///
+		/// \throws std::runtime_error If the screen number is out of range
+		///
+		////////////////////////////////////////////////////////////
+		std::vector<LevelSprite>::const_iterator screenEnd(int screen) const;
+
+	protected:
+
+		////////////////////////////////////////////////////////////
+		/// \brief Throws if the screen is out of range
+		////////////////////////////////////////////////////////////
+		void checkScreen(int screen) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The sprite header byte
+		////////////////////////////////////////////////////////////
+		std::uint8_t header;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Every sprite, in screen order
+		////////////////////////////////////////////////////////////
+		std::vector<LevelSprite> sprites;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The index in sprites of the first sprite on each screen, plus one extra entry holding the sprite count
+		////////////////////////////////////////////////////////////
+		std::array<std::uint16_t, screenCount + 1> screenStarts;
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief Returns the SNES address of the specified level's sprite data (which starts with its sprite header byte).
+	/// \details The low two bytes come from the sprite pointer table at $05EC00, and the bank byte from Lunar Magic's table at $0EF100.
+	///
+	/// \param romStart		An iterator pointing to the beginning of the ROM data
+	/// \param romEnd		An iterator pointing to the end of the ROM data
+	/// \param level		The level to get the sprite data address of
+	///
+	/// \return SNES address of the level's sprite data
+	///
+	/// \throws std::runtime_error If the ROM did not contain this data (e.g. the ROM being cut-off partway through table data)
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType>
+	int getLevelSpriteDataAddress(inputIteratorType romStart, inputIteratorType romEnd, int level);
+
+
+//////////////////////////////////////////////////////////////////////////////
+///  @}
+//////////////////////////////////////////////////////////////////////////////
+}
+
+#include "LevelSprites.inl"
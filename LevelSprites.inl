@@ -0,0 +1,126 @@
+#include "Internal.hpp"
+#include <stdexcept>
+#include <iterator>
+#include <algorithm>
+
+namespace worldlib
+{
+	template <typename inputIteratorType>
+	int getLevelSpriteDataAddress(inputIteratorType romStart, inputIteratorType romEnd, int level)
+	{
+		return readWordSFC(romStart, romEnd, internal::spritePointerTableLocation + level * 2) | (readByteSFC(romStart, romEnd, internal::spriteDataBankTableLocation + level) << 16);
+	}
+
+	inline LevelSpriteList::LevelSpriteList() : header(0)
+	{
+		screenStarts.fill(0);
+	}
+
+	template <typename inputIteratorType>
+	LevelSpriteList::LevelSpriteList(inputIteratorType romStart, inputIteratorType romEnd, int level) : LevelSpriteList()
+	{
+		int dataOffset = SFCToPC(romStart, romEnd, getLevelSpriteDataAddress(romStart, romEnd, level));
+		auto remaining = std::distance(romStart, romEnd) - dataOffset;
+		if (remaining <= 0)
+			throw std::runtime_error("Address is out of bounds for the current ROM.");
+
+		auto current = romStart;
+		std::advance(current, dataOffset);
+
+		header = static_cast<std::uint8_t>(*current);
+		++current;
+		remaining--;
+
+		bool inScreenOrder = true;
+		for (;;)
+		{
+			if (remaining <= 0)
+				throw std::runtime_error("Sprite data ended before its end marker.");
+			std::uint8_t byte1 = static_cast<std::uint8_t>(*current);
+			if (byte1 == 0xFF) break;
+			if (remaining < 3)
+				throw std::runtime_error("Sprite data ended before its end marker.");
+
+			++current;
+			std::uint8_t byte2 = static_cast<std::uint8_t>(*current);
+			++current;
+			std::uint8_t byte3 = static_cast<std::uint8_t>(*current);
+			++current;
+			remaining -= 3;
+
+			// yyyyEESY XXXXssss NNNNNNNN
+			LevelSprite sprite;
+			sprite.screen = ((byte1 & 0x02) << 3) | (byte2 & 0x0F);
+			sprite.x = byte2 >> 4;
+			sprite.y = ((byte1 & 0x01) << 4) | (byte1 >> 4);
+			sprite.extraBits = (byte1 & 0x0C) >> 2;
+			sprite.number = byte3;
+			sprite.padding = 0;
+			sprite.index = (std::uint16_t)sprites.size();
+
+			if (sprites.empty() == false && sprite.screen < sprites.back().screen)
+				inScreenOrder = false;
+			sprites.push_back(sprite);
+		}
+
+		if (inScreenOrder == false)
+			std::stable_sort(sprites.begin(), sprites.end(), [](const LevelSprite &a, const LevelSprite &b) { return a.screen < b.screen; });
+
+		int spriteIndex = 0;
+		for (int screen = 0; screen <= screenCount; screen++)
+		{
+			while (spriteIndex < (int)sprites.size() && sprites[spriteIndex].screen < screen)
+				spriteIndex++;
+			screenStarts[screen] = spriteIndex;
+		}
+	}
+
+	inline void LevelSpriteList::checkScreen(int screen) const
+	{
+		if (screen < 0 || screen >= screenCount)
+			throw std::runtime_error("Screen number is out of range.");
+	}
+
+	inline std::uint8_t LevelSpriteList::getHeader() const
+	{
+		return header;
+	}
+
+	inline int LevelSpriteList::getSpriteMemorySetting() const
+	{
+		return header & 0x3F;
+	}
+
+	inline bool LevelSpriteList::hasBuoyancy() const
+	{
+		return (header & 0x80) != 0;
+	}
+
+	inline int LevelSpriteList::getSpriteCount() const
+	{
+		return (int)sprites.size();
+	}
+
+	inline const std::vector<LevelSprite> &LevelSpriteList::getSprites() const
+	{
+		return sprites;
+	}
+
+	inline int LevelSpriteList::getScreenSpriteCount(int screen) const
+	{
+		checkScreen(screen);
+		return screenStarts[screen + 1] - screenStarts[screen];
+	}
+
+	inline std::vector<LevelSprite>::const_iterator LevelSpriteList::screenBegin(int screen) const
+	{
+		checkScreen(screen);
+		return sprites.begin() + screenStarts[screen];
+	}
+
+	inline std::vector<LevelSprite>::const_iterator LevelSpriteList::screenEnd(int screen) const
+	{
+		checkScreen(screen);
+		return sprites.begin() + screenStarts[screen + 1];
+	}
+}
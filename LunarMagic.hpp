@@ -1,4 +1,5 @@
 ﻿#pragma once
+#include "Result.hpp"
 
 //////////////////////////////////////////////////////////////////////////////
 /// \file LunarMagic.hpp
@@ -42,6 +43,16 @@ namespace worldlib
 	template <typename inputIteratorType>
 	bool checkROMValid(inputIteratorType romStart, inputIteratorType romEnd);
 
+	////////////////////////////////////////////////////////////
+	/// \ingroup LunarMagic
+	/// \brief Same as checkROMValid, but returns an error instead of throwing.  checkROMValid is a wrapper around this.
+	///
+	/// \return True if the correct conditions apply, or ErrorCode::ROMTooSmall if the ROM is cut off before the end of Lunar Magic's string, or an error from reading the internal header (see tryReadByteSFC)
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType>
+	Result<bool> tryCheckROMValid(inputIteratorType romStart, inputIteratorType romEnd) noexcept;
+
 	////////////////////////////////////////////////////////////
 	/// \ingroup LunarMagic
 	/// \brief Gets the string Lunar Magic inserts into the ROM as an identifier.  General format seems to be "Lunar Magic Version 2.21 Public ©2013 FuSoYa, Defender of Relm http://fusoya.eludevisibility.org                                ".  Probably won't need to use this, since checkROMModified and checkROMVersion should provide the same functionality.
@@ -20,24 +20,48 @@ namespace worldlib
 	}
 
 	template <typename inputIteratorType>
-	bool checkROMValid(inputIteratorType romStart, inputIteratorType romEnd)
+	Result<bool> tryCheckROMValid(inputIteratorType romStart, inputIteratorType romEnd) noexcept
 	{
 		int romSize = std::distance(romStart, romEnd);
 
-		std::string lmStr;
+		// The same checks as getLunarMagicString and getROMTitle make, without building strings (which could throw).
+		auto stringStart = trySFCToPC(romStart, romEnd, 0x0FF0A0);
+		if (!stringStart) return stringStart.error();
+		auto stringEnd = trySFCToPC(romStart, romEnd, 0x0FF120);
+		if (!stringEnd) return stringEnd.error();
+		if (stringEnd.value() >= romSize) return ErrorCode::ROMTooSmall;
+
+		const char wantStr[] = "Lunar Magic";
+		bool lunarMagicked = true;
+		auto current = romStart;
+		std::advance(current, stringStart.value());
+		for (int i = 0; i < 0xB; i++, ++current)
+			if (static_cast<std::uint8_t>(*current) != static_cast<std::uint8_t>(wantStr[i])) lunarMagicked = false;
+
+		auto country = tryReadByteSFC(romStart, romEnd, 0xFFD9);
+		if (!country) return country.error();
+
+		const char wantTitle[] = "SUPER MARIOWORLD     ";				// getROMTitle trims the spaces at the end of the 21 byte title.
+		bool isSMW = true;
+		for (int i = 0; i < 21; i++)
+		{
+			auto byte = tryReadByteSFC(romStart, romEnd, 0xFFC0 + i);
+			if (!byte) return byte.error();
+			if (byte.value() != static_cast<std::uint8_t>(wantTitle[i])) isSMW = false;
+		}
 
-		getLunarMagicString(romStart, romEnd, std::back_inserter(lmStr));
-		std::string wantStr = "Lunar Magic";
 		bool sizeIsGood = romSize >= 0x100000;
-		bool lunarMagicked = lmStr.substr(0, 0xB) == wantStr;
-		bool isUSROM = readByteSFC(romStart, romEnd, 0xFFD9) == 0x01;
-		std::string romTitle;
-		getROMTitle(romStart, romEnd, std::back_inserter(romTitle), true);
-		bool isSMW = romTitle == "SUPER MARIOWORLD";
+		bool isUSROM = country.value() == 0x01;
 
 		return sizeIsGood && lunarMagicked && isUSROM && isSMW;
 	}
 
+	template <typename inputIteratorType>
+	bool checkROMValid(inputIteratorType romStart, inputIteratorType romEnd)
+	{
+		return tryCheckROMValid(romStart, romEnd).value();
+	}
+
 	template <typename inputIteratorType, typename outputIteratorType>
 	outputIteratorType getLunarMagicString(inputIteratorType romStart, inputIteratorType romEnd, outputIteratorType out)
 	{
@@ -0,0 +1,297 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <map>
+#include <unordered_map>
+#include <cstdint>
+#include "Level.hpp"
+
+namespace worldlib
+{
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file Map16.hpp
+/// \brief Contains classes for working with Map16 blocks (the 16x16 blocks levels are built out of).
+///
+/// \addtogroup Level
+///  @{
+//////////////////////////////////////////////////////////////////////////////
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief One 8x8 tile of a Map16 block, in the SNES tilemap format (YXPCCCTT TTTTTTTT)
+	////////////////////////////////////////////////////////////
+	struct Map16Tile
+	{
+		////////////////////////////////////////////////////////////
+		/// \brief The raw 16-bit tilemap entry
+		////////////////////////////////////////////////////////////
+		std::uint16_t raw;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the 8x8 tile number (0 - 3FF)
+		////////////////////////////////////////////////////////////
+		int getTileNumber() const { return raw & 0x3FF; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the palette row (0 - 7)
+		////////////////////////////////////////////////////////////
+		int getPalette() const { return (raw >> 10) & 0x07; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns true if the tile is drawn above sprites with normal priority
+		////////////////////////////////////////////////////////////
+		bool getPriority() const { return (raw & 0x2000) != 0; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns true if the tile is flipped horizontally
+		////////////////////////////////////////////////////////////
+		bool getFlipX() const { return (raw & 0x4000) != 0; }
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns true if the tile is flipped vertically
+		////////////////////////////////////////////////////////////
+		bool getFlipY() const { return (raw & 0x8000) != 0; }
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief A 16x16 Map16 block:  four 8x8 tiles in SMW's order of top-left, bottom-left, top-right, bottom-right
+	////////////////////////////////////////////////////////////
+	struct Map16Block
+	{
+		std::array<Map16Tile, 4> tiles;
+	};
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief Holds Map16 pages and looks up blocks in them, honoring Lunar Magic's tileset-specific pages.
+	/// \details Pages are loaded from raw Map16 data:  8 bytes per block (four little-endian tilemap entries in the order above), 0x800 bytes per page.
+	/// This is the format blocks are stored in, both in the ROM and in Lunar Magic's exported Map16 data.
+	///
+	/// In Lunar Magic, some pages can have different blocks for each tileset.  Load those with setTilesetPage;  getBlock uses a tileset's own version of a page if it has one, and the shared version otherwise.
+	///
+	/// There is no loader that reads the pages straight out of a ROM.  The original game and each version of Lunar Magic store Map16 in different places and formats,
+	/// so finding the pages is left to you (e.g. from Lunar Magic's exported Map16 data), the same as placing objects is left to LevelObjectDrawer.
+	////////////////////////////////////////////////////////////
+	class Map16Table
+	{
+	public:
+
+		////////////////////////////////////////////////////////////
+		/// \brief How many blocks are on a page
+		////////////////////////////////////////////////////////////
+		static const int blocksPerPage = 0x100;
+
+		////////////////////////////////////////////////////////////
+		/// \brief How many pages there are (0 - 3F for layer 1, 40 - 7F for layer 2 backgrounds)
+		////////////////////////////////////////////////////////////
+		static const int pageCount = 0x80;
+
+		////////////////////////////////////////////////////////////
+		/// \brief How many FG/BG tilesets there are
+		////////////////////////////////////////////////////////////
+		static const int tilesetCount = 0x10;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Creates an empty table.  No page is loaded.
+		////////////////////////////////////////////////////////////
+		Map16Table();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Loads a page shared by every tileset.
+		///
+		/// \param page			The page to load (0 - 7F)
+		/// \param dataStart		An iterator pointing to the start of the page's raw Map16 data
+		/// \param dataEnd		An iterator pointing to the end of the page's raw Map16 data.  Blocks past the end of the data are left blank.
+		///
+		/// \throws std::runtime_error If the page number is out of range
+		///
+		////////////////////////////////////////////////////////////
+		template <typename inputIteratorType>
+		void setPage(int page, inputIteratorType dataStart, inputIteratorType dataEnd);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Loads one tileset's own version of a page.
+		///
+		/// \param tileset		The tileset the page belongs to (0 - F)
+		/// \param page			The page to load (0 - 7F)
+		/// \param dataStart		An iterator pointing to the start of the page's raw Map16 data
+		/// \param dataEnd		An iterator pointing to the end of the page's raw Map16 data.  Blocks past the end of the data are left blank.
+		///
+		/// \throws std::runtime_error If the tileset or page number is out of range
+		///
+		////////////////////////////////////////////////////////////
+		template <typename inputIteratorType>
+		void setTilesetPage(int tileset, int page, inputIteratorType dataStart, inputIteratorType dataEnd);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Removes a tileset's own version of a page, so it goes back to using the shared one
+		///
+		/// \throws std::runtime_error If the tileset or page number is out of range
+		///
+		////////////////////////////////////////////////////////////
+		void clearTilesetPage(int tileset, int page);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns true if the block can be looked up for the tileset (i.e. its page has been loaded either for the tileset or for everyone)
+		////////////////////////////////////////////////////////////
+		bool hasBlock(int tileset, int block) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the specified block as the specified tileset sees it.
+		///
+		/// \param tileset		The tileset to look the block up for (0 - F)
+		/// \param block		The block number (0 - 7FFF)
+		///
+		/// \throws std::runtime_error If the tileset or block number is out of range, or the block's page hasn't been loaded
+		///
+		////////////////////////////////////////////////////////////
+		const Map16Block &getBlock(int tileset, int block) const;
+
+	protected:
+
+		////////////////////////////////////////////////////////////
+		/// \brief Decodes raw Map16 data into a page's blocks
+		////////////////////////////////////////////////////////////
+		template <typename inputIteratorType>
+		static std::vector<Map16Block> decodePage(inputIteratorType dataStart, inputIteratorType dataEnd);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Throws if the tileset or page is out of range
+		////////////////////////////////////////////////////////////
+		static void checkTilesetAndPage(int tileset, int page);
+
+		////////////////////////////////////////////////////////////
+		/// \brief The shared pages.  Pages that haven't been loaded are empty.
+		////////////////////////////////////////////////////////////
+		std::vector<std::vector<Map16Block>> pages;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Tileset-specific pages, keyed by tileset * pageCount + page
+		////////////////////////////////////////////////////////////
+		std::map<int, std::vector<Map16Block>> tilesetPages;
+	};
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief Caches fully drawn 16x16 Map16 blocks, so drawing a level is just copying finished blocks.
+	/// \details Blocks are keyed by (tileset, block, palette set, graphics set).  The tileset picks which version of the block to use (see Map16Table).
+	/// The palette set is any number you like that identifies the palette, e.g. an index into LevelPaletteTable::palettes.
+	/// The graphics set is any number you like that identifies the contents of vram, e.g. an index into a list of the different LevelGraphicsDescriptor::slots you've drawn with.
+	/// Levels with the same tileset can still have different graphics (ExGFX), so blocks drawn from different vram must be given different graphics sets, or they'll get each other's pixels.
+	/// If the palette or graphics behind a palette set or graphics set change, call invalidatePaletteSet or invalidateGraphicsSet.
+	///
+	/// Each block is drawn by decoding its four tiles with indexedImageToBitmap, so transparent pixels (color 0) have an alpha of 0.
+	////////////////////////////////////////////////////////////
+	class Map16BlockCache
+	{
+	public:
+
+		////////////////////////////////////////////////////////////
+		/// \brief A drawn block:  16x16 ARGB pixels, one row after another
+		////////////////////////////////////////////////////////////
+		typedef std::array<std::uint32_t, 16 * 16> BlockBitmap;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Creates an empty cache that draws blocks from the specified table.  The table must outlive the cache.
+		////////////////////////////////////////////////////////////
+		explicit Map16BlockCache(const Map16Table &table);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the drawn block, drawing it first if it isn't in the cache yet.
+		/// \details Tiles 000 - 2FF are read from vram as 4bpp graphics, which is what composeLevelVRAM's first six slots (FG1 - BG3) hold.  Tiles 300 - 3FF, and tiles past the end of vram, are drawn transparent.
+		///
+		/// \param tileset		The tileset to look the block up for
+		/// \param block		The block number
+		/// \param paletteSet		Your number for the palette
+		/// \param graphicsSet		Your number for the graphics in vram
+		/// \param vramStart		An iterator pointing to the start of the 4bpp graphics the block's tiles refer to (e.g. composeLevelVRAM's buffer)
+		/// \param vramEnd		An iterator pointing to the end of the graphics
+		/// \param paletteStart		An iterator pointing to the start of the 256-color ARGB palette (e.g. from getLevelPalette)
+		/// \param paletteEnd		An iterator pointing to the end of the palette
+		///
+		/// \return The drawn block.  The reference stays valid until the block is invalidated or the cache is cleared.
+		///
+		/// \throws std::runtime_error If the block can't be looked up (see Map16Table::getBlock), or if the palette is too small
+		///
+		////////////////////////////////////////////////////////////
+		template <typename vramIteratorType, typename paletteIteratorType>
+		const BlockBitmap &getBlock(int tileset, int block, int paletteSet, int graphicsSet, vramIteratorType vramStart, vramIteratorType vramEnd, paletteIteratorType paletteStart, paletteIteratorType paletteEnd);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns true if the block is already in the cache
+		////////////////////////////////////////////////////////////
+		bool contains(int tileset, int block, int paletteSet, int graphicsSet) const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Removes every block drawn for the specified tileset
+		////////////////////////////////////////////////////////////
+		void invalidateTileset(int tileset);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Removes every block drawn with the specified palette set
+		////////////////////////////////////////////////////////////
+		void invalidatePaletteSet(int paletteSet);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Removes every block drawn from the specified graphics set
+		////////////////////////////////////////////////////////////
+		void invalidateGraphicsSet(int graphicsSet);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Removes every block
+		////////////////////////////////////////////////////////////
+		void clear();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns how many blocks are in the cache
+		////////////////////////////////////////////////////////////
+		int size() const;
+
+	protected:
+
+		////////////////////////////////////////////////////////////
+		/// \brief What a drawn block is looked up by
+		////////////////////////////////////////////////////////////
+		struct Key
+		{
+			int tileset;
+			int block;
+			int paletteSet;
+			int graphicsSet;
+
+			bool operator==(const Key &other) const { return tileset == other.tileset && block == other.block && paletteSet == other.paletteSet && graphicsSet == other.graphicsSet; }
+		};
+
+		////////////////////////////////////////////////////////////
+		/// \brief Hashes a Key for blocks
+		////////////////////////////////////////////////////////////
+		struct KeyHash
+		{
+			std::size_t operator()(const Key &key) const;
+		};
+
+		////////////////////////////////////////////////////////////
+		/// \brief Removes every block the predicate returns true for
+		////////////////////////////////////////////////////////////
+		template <typename predicateType>
+		void invalidateIf(predicateType predicate);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Where the blocks come from
+		////////////////////////////////////////////////////////////
+		const Map16Table *table;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The drawn blocks
+		////////////////////////////////////////////////////////////
+		std::unordered_map<Key, BlockBitmap, KeyHash> blocks;
+	};
+
+
+//////////////////////////////////////////////////////////////////////////////
+///  @}
+//////////////////////////////////////////////////////////////////////////////
+}
+
+#include "Map16.inl"
@@ -0,0 +1,193 @@
+#include "Internal.hpp"
+#include <stdexcept>
+#include <iterator>
+
+namespace worldlib
+{
+	inline Map16Table::Map16Table() : pages(pageCount)
+	{
+	}
+
+	inline void Map16Table::checkTilesetAndPage(int tileset, int page)
+	{
+		if (tileset < 0 || tileset >= tilesetCount)
+			throw std::runtime_error("Tileset number is out of range.");
+		if (page < 0 || page >= pageCount)
+			throw std::runtime_error("Map16 page number is out of range.");
+	}
+
+	template <typename inputIteratorType>
+	std::vector<Map16Block> Map16Table::decodePage(inputIteratorType dataStart, inputIteratorType dataEnd)
+	{
+		Map16Block blank;
+		for (auto &tile : blank.tiles) tile.raw = 0;
+		std::vector<Map16Block> result(blocksPerPage, blank);
+
+		auto current = dataStart;
+		for (int block = 0; block < blocksPerPage; block++)
+		{
+			for (int tile = 0; tile < 4; tile++)
+			{
+				if (current == dataEnd) return result;
+				std::uint16_t low = static_cast<std::uint8_t>(*current);
+				++current;
+				if (current == dataEnd) return result;
+				std::uint16_t high = static_cast<std::uint8_t>(*current);
+				++current;
+				result[block].tiles[tile].raw = low | (high << 8);
+			}
+		}
+		return result;
+	}
+
+	template <typename inputIteratorType>
+	void Map16Table::setPage(int page, inputIteratorType dataStart, inputIteratorType dataEnd)
+	{
+		checkTilesetAndPage(0, page);
+		pages[page] = decodePage(dataStart, dataEnd);
+	}
+
+	template <typename inputIteratorType>
+	void Map16Table::setTilesetPage(int tileset, int page, inputIteratorType dataStart, inputIteratorType dataEnd)
+	{
+		checkTilesetAndPage(tileset, page);
+		tilesetPages[tileset * pageCount + page] = decodePage(dataStart, dataEnd);
+	}
+
+	inline void Map16Table::clearTilesetPage(int tileset, int page)
+	{
+		checkTilesetAndPage(tileset, page);
+		tilesetPages.erase(tileset * pageCount + page);
+	}
+
+	inline bool Map16Table::hasBlock(int tileset, int block) const
+	{
+		if (tileset < 0 || tileset >= tilesetCount || block < 0 || block >= pageCount * blocksPerPage)
+			return false;
+
+		int page = block / blocksPerPage;
+		return pages[page].empty() == false || tilesetPages.count(tileset * pageCount + page) != 0;
+	}
+
+	inline const Map16Block &Map16Table::getBlock(int tileset, int block) const
+	{
+		if (block < 0 || block >= pageCount * blocksPerPage)
+			throw std::runtime_error("Map16 block number is out of range.");
+
+		int page = block / blocksPerPage;
+		checkTilesetAndPage(tileset, page);
+
+		auto tilesetPage = tilesetPages.find(tileset * pageCount + page);
+		if (tilesetPage != tilesetPages.end())
+			return tilesetPage->second[block % blocksPerPage];
+
+		if (pages[page].empty())
+			throw std::runtime_error("Map16 page has not been loaded.");
+		return pages[page][block % blocksPerPage];
+	}
+
+
+
+	inline Map16BlockCache::Map16BlockCache(const Map16Table &table) : table(&table)
+	{
+	}
+
+	inline std::size_t Map16BlockCache::KeyHash::operator()(const Key &key) const
+	{
+		std::uint64_t packed = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(key.paletteSet)) << 32) | (static_cast<std::uint64_t>(key.tileset & 0xFFFF) << 16) | static_cast<std::uint64_t>(key.block & 0xFFFF);
+		return std::hash<std::uint64_t>()(packed ^ (static_cast<std::uint64_t>(static_cast<std::uint32_t>(key.graphicsSet)) * 0x9E3779B97F4A7C15ull));
+	}
+
+	template <typename vramIteratorType, typename paletteIteratorType>
+	const Map16BlockCache::BlockBitmap &Map16BlockCache::getBlock(int tileset, int block, int paletteSet, int graphicsSet, vramIteratorType vramStart, vramIteratorType vramEnd, paletteIteratorType paletteStart, paletteIteratorType paletteEnd)
+	{
+		Key key = { tileset, block, paletteSet, graphicsSet };
+		auto found = blocks.find(key);
+		if (found != blocks.end())
+			return found->second;
+
+		const Map16Block &map16Block = table->getBlock(tileset, block);
+		auto vramSize = std::distance(vramStart, vramEnd);
+
+		BlockBitmap bitmap;
+		std::vector<std::uint32_t> tilePixels;
+		tilePixels.reserve(64);
+
+		for (int i = 0; i < 4; i++)
+		{
+			const Map16Tile &tile = map16Block.tiles[i];
+			int left = (i & 2) ? 8 : 0;			// Top-left, bottom-left, top-right, bottom-right
+			int top = (i & 1) ? 8 : 0;
+
+			int tileOffset = tile.getTileNumber() * 32;
+			tilePixels.clear();
+			if (tile.getTileNumber() < 0x300 && tileOffset + 32 <= vramSize)		// Past 2FF is composeLevelVRAM's sprite slots, which aren't background graphics.
+			{
+				auto tileStart = vramStart;
+				std::advance(tileStart, tileOffset);
+				auto tileEnd = tileStart;
+				std::advance(tileEnd, 32);
+				indexedImageToBitmap(tileStart, tileEnd, paletteStart, paletteEnd, 4, false, false, tile.getPalette(), std::back_inserter(tilePixels));
+			}
+			else
+			{
+				tilePixels.assign(64, 0);
+			}
+
+			for (int y = 0; y < 8; y++)
+			{
+				int sourceY = tile.getFlipY() ? 7 - y : y;
+				for (int x = 0; x < 8; x++)
+				{
+					int sourceX = tile.getFlipX() ? 7 - x : x;
+					bitmap[(top + y) * 16 + left + x] = tilePixels[sourceY * 8 + sourceX];
+				}
+			}
+		}
+
+		return blocks.insert(std::make_pair(key, bitmap)).first->second;
+	}
+
+	inline bool Map16BlockCache::contains(int tileset, int block, int paletteSet, int graphicsSet) const
+	{
+		Key key = { tileset, block, paletteSet, graphicsSet };
+		return blocks.count(key) != 0;
+	}
+
+	template <typename predicateType>
+	void Map16BlockCache::invalidateIf(predicateType predicate)
+	{
+		for (auto it = blocks.begin(); it != blocks.end();)
+		{
+			if (predicate(it->first))
+				it = blocks.erase(it);
+			else
+				++it;
+		}
+	}
+
+	inline void Map16BlockCache::invalidateTileset(int tileset)
+	{
+		invalidateIf([tileset](const Key &key) { return key.tileset == tileset; });
+	}
+
+	inline void Map16BlockCache::invalidatePaletteSet(int paletteSet)
+	{
+		invalidateIf([paletteSet](const Key &key) { return key.paletteSet == paletteSet; });
+	}
+
+	inline void Map16BlockCache::invalidateGraphicsSet(int graphicsSet)
+	{
+		invalidateIf([graphicsSet](const Key &key) { return key.graphicsSet == graphicsSet; });
+	}
+
+	inline void Map16BlockCache::clear()
+	{
+		blocks.clear();
+	}
+
+	inline int Map16BlockCache::size() const
+	{
+		return (int)blocks.size();
+	}
+}
@@ -0,0 +1,226 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace worldlib
+{
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file PNG.hpp
+/// \brief Contains functions for saving images as PNGs without any other libraries.
+///
+/// \addtogroup Level
+///  @{
+//////////////////////////////////////////////////////////////////////////////
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief How hard to try to make PNGs small
+	////////////////////////////////////////////////////////////
+	enum class PNGCompression : int
+	{
+		Store = 0,		///< No compression at all.  Fastest, but the files are huge.
+		Fast = 1,		///< Only looks for runs of repeated bytes and pixels.  Fast, and works well on tile graphics and level renders.
+		Best = 2		///< Searches for repeated data everywhere and picks the best filter for each row.  Several times slower, for archiving.
+	};
+
+	namespace internal
+	{
+		////////////////////////////////////////////////////////////
+		/// \brief A zlib stream compressor that can be fed data a piece at a time.  Used by PNGWriter.
+		////////////////////////////////////////////////////////////
+		class DeflateEncoder
+		{
+		public:
+			DeflateEncoder(PNGCompression compression, int runDistance);
+
+			// Compresses data as one or more blocks and appends the finished bytes to out.  final ends the stream (and adds the checksum).
+			void compress(const std::uint8_t *data, std::size_t size, bool final, std::vector<std::uint8_t> &out);
+
+		protected:
+			struct Symbol
+			{
+				std::uint16_t value;		// A literal byte, or the length of a match
+				std::uint16_t distance;		// 0 for literals
+			};
+
+			void writeBits(std::uint32_t bits, int count, std::vector<std::uint8_t> &out);
+			void alignToByte(std::vector<std::uint8_t> &out);
+			void writeStoredBlock(const std::uint8_t *data, std::size_t size, bool final, std::vector<std::uint8_t> &out);
+			void writeHuffmanBlock(const std::vector<Symbol> &symbols, const std::uint8_t *data, std::size_t size, bool final, std::vector<std::uint8_t> &out);
+			void findSymbols(std::size_t start, std::size_t end, std::vector<Symbol> &symbols);
+			int findMatch(std::size_t position, std::size_t end, int &distance);
+			std::uint8_t byteAt(std::size_t position) const;
+			int getLengthCode(int length) const;
+			int getDistanceCode(int distance) const;
+
+			PNGCompression compression;
+			int runDistance;
+			bool headerWritten;
+			std::uint32_t adlerA, adlerB;
+			std::uint64_t bitBuffer;
+			int bitCount;
+
+			std::vector<std::uint8_t> window;		// The data being compressed, plus the 32kb before it
+			std::size_t windowStart;			// Position of window[0] in the whole stream
+			std::size_t hashed;				// Every position before this is in the hash chains
+			std::vector<std::size_t> hashHeads;
+			std::vector<std::size_t> hashChains;
+
+			std::array<std::uint8_t, 259> lengthCodes;
+			std::array<std::uint8_t, 512> distanceCodes;
+		};
+	}
+
+	////////////////////////////////////////////////////////////
+	/// \brief Writes a PNG one row at a time, so a whole image never has to be in memory at once.
+	/// \details Truecolor images take ARGB pixels (like indexedImageToBitmap's output) and are saved as 8-bit RGBA.
+	/// Indexed images take one palette index per pixel and are saved as palette PNGs, with transparency for any palette entries whose alpha isn't FF.
+	///
+	/// The bytes are sent to out as they're made, so writing to std::ostreambuf_iterator streams straight into a file.
+	/// Make one with makePNGWriter or makeIndexedPNGWriter, or use writePNG/writeIndexedPNG if you already have the whole image.
+	////////////////////////////////////////////////////////////
+	template <typename outputIteratorType>
+	class PNGWriter
+	{
+	public:
+
+		////////////////////////////////////////////////////////////
+		/// \brief Starts a truecolor PNG and writes its header.
+		///
+		/// \param out			Where to send the PNG's bytes
+		/// \param width		Width of the image in pixels
+		/// \param height		Height of the image in pixels
+		/// \param compression		How hard to try to make the file small
+		///
+		/// \throws std::runtime_error If the width or height is 0 or less
+		///
+		////////////////////////////////////////////////////////////
+		PNGWriter(outputIteratorType out, int width, int height, PNGCompression compression = PNGCompression::Fast);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Starts an indexed PNG and writes its header and palette.
+		///
+		/// \param out			Where to send the PNG's bytes
+		/// \param width		Width of the image in pixels
+		/// \param height		Height of the image in pixels
+		/// \param paletteStart		An iterator pointing to the start of the ARGB palette (e.g. from getLevelPalette)
+		/// \param paletteEnd		An iterator pointing to the end of the palette.  Must be 1 - 256 colors long.
+		/// \param compression		How hard to try to make the file small
+		///
+		/// \throws std::runtime_error If the width or height is 0 or less, or if the palette is empty or has more than 256 colors
+		///
+		////////////////////////////////////////////////////////////
+		template <typename paletteIteratorType>
+		PNGWriter(outputIteratorType out, int width, int height, paletteIteratorType paletteStart, paletteIteratorType paletteEnd, PNGCompression compression = PNGCompression::Fast);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Adds the next row of the image.
+		///
+		/// \param rowStart		An iterator pointing to the start of the row:  ARGB pixels for truecolor images, palette indices for indexed ones
+		/// \param rowEnd		An iterator pointing to the end of the row.  The row must be exactly as wide as the image.
+		///
+		/// \throws std::runtime_error If the row is the wrong width, or every row has already been written
+		///
+		////////////////////////////////////////////////////////////
+		template <typename inputIteratorType>
+		void writeRow(inputIteratorType rowStart, inputIteratorType rowEnd);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns how many rows have been written so far
+		////////////////////////////////////////////////////////////
+		int getRowsWritten() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Finishes the PNG once every row has been written.
+		///
+		/// \return Iterator pointing to the end of the PNG data
+		///
+		/// \throws std::runtime_error If not every row has been written, or the PNG was already finished
+		///
+		////////////////////////////////////////////////////////////
+		outputIteratorType finish();
+
+	protected:
+		void writeHeader(const std::vector<std::uint32_t> &palette);
+		void writeChunk(const char *type, const std::uint8_t *data, std::size_t size);
+		void flushCompressed(bool everything);
+		void filterRow();
+
+		outputIteratorType out;
+		int width;
+		int height;
+		int rowsWritten;
+		bool indexed;
+		bool finished;
+		PNGCompression compression;
+		int bytesPerPixel;
+
+		std::vector<std::uint8_t> currentRow;
+		std::vector<std::uint8_t> previousRow;
+		std::vector<std::uint8_t> filterScratch;
+		std::vector<std::uint8_t> pending;		// Filtered rows waiting to be compressed
+		std::vector<std::uint8_t> compressed;		// Compressed bytes waiting to go into an IDAT chunk
+		internal::DeflateEncoder encoder;
+		std::array<std::uint32_t, 256> crcTable;
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief Makes a PNGWriter for a truecolor image.  See PNGWriter's constructor.
+	////////////////////////////////////////////////////////////
+	template <typename outputIteratorType>
+	PNGWriter<outputIteratorType> makePNGWriter(outputIteratorType out, int width, int height, PNGCompression compression = PNGCompression::Fast);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Makes a PNGWriter for an indexed image.  See PNGWriter's constructor.
+	////////////////////////////////////////////////////////////
+	template <typename outputIteratorType, typename paletteIteratorType>
+	PNGWriter<outputIteratorType> makeIndexedPNGWriter(outputIteratorType out, int width, int height, paletteIteratorType paletteStart, paletteIteratorType paletteEnd, PNGCompression compression = PNGCompression::Fast);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Saves a whole ARGB image (like indexedImageToBitmap's output) as a PNG.
+	///
+	/// \param pixelsStart		An iterator pointing to the start of the ARGB pixels, one row after another
+	/// \param pixelsEnd		An iterator pointing to the end of the pixels.  Must be exactly width * height pixels.
+	/// \param width		Width of the image in pixels
+	/// \param height		Height of the image in pixels
+	/// \param out			Where to send the PNG's bytes
+	/// \param compression		How hard to try to make the file small
+	///
+	/// \return Iterator pointing to the end of the PNG data
+	///
+	/// \throws std::runtime_error If the width or height is 0 or less, or there aren't exactly width * height pixels
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType, typename outputIteratorType>
+	outputIteratorType writePNG(inputIteratorType pixelsStart, inputIteratorType pixelsEnd, int width, int height, outputIteratorType out, PNGCompression compression = PNGCompression::Fast);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Saves a whole image made of palette indices as a palette PNG.
+	///
+	/// \param indicesStart		An iterator pointing to the start of the palette indices, one byte per pixel, one row after another
+	/// \param indicesEnd		An iterator pointing to the end of the indices.  Must be exactly width * height pixels.
+	/// \param width		Width of the image in pixels
+	/// \param height		Height of the image in pixels
+	/// \param paletteStart		An iterator pointing to the start of the ARGB palette (e.g. from getLevelPalette)
+	/// \param paletteEnd		An iterator pointing to the end of the palette.  Must be 1 - 256 colors long.
+	/// \param out			Where to send the PNG's bytes
+	/// \param compression		How hard to try to make the file small
+	///
+	/// \return Iterator pointing to the end of the PNG data
+	///
+	/// \throws std::runtime_error If the width or height is 0 or less, the palette is empty or too large, or there aren't exactly width * height pixels
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType, typename paletteIteratorType, typename outputIteratorType>
+	outputIteratorType writeIndexedPNG(inputIteratorType indicesStart, inputIteratorType indicesEnd, int width, int height, paletteIteratorType paletteStart, paletteIteratorType paletteEnd, outputIteratorType out, PNGCompression compression = PNGCompression::Fast);
+
+
+//////////////////////////////////////////////////////////////////////////////
+///  @}
+//////////////////////////////////////////////////////////////////////////////
+}
+
+#include "PNG.inl"
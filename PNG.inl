@@ -0,0 +1,768 @@
+#include "Internal.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <cstdlib>
+#include <queue>
+#include <functional>
+#include <utility>
+
+namespace worldlib
+{
+	namespace internal
+	{
+		const int deflateLengthBases[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+		const int deflateLengthExtraBits[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+		const int deflateDistanceBases[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+		const int deflateDistanceExtraBits[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+		const int deflateCodeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+		const int deflateWindowSize = 0x8000;
+		const int deflateMaxMatch = 258;
+		const int deflateMaxChain = 128;				// How many earlier matches PNGCompression::Best checks before giving up
+		const std::size_t deflateNoPosition = static_cast<std::size_t>(-1);
+
+		// Makes length-limited Huffman code lengths for the symbol frequencies.  If the tree ends up too deep, the frequencies are flattened and it's tried again.
+		inline void buildHuffmanLengths(const std::uint32_t *frequencies, int count, int maxBits, std::uint8_t *lengths)
+		{
+			std::vector<std::uint32_t> weights(frequencies, frequencies + count);
+
+			int used = 0;
+			for (auto w : weights) if (w != 0) used++;
+			for (int i = 0; i < count && used < 2; i++)			// A code needs at least two symbols to be complete.
+			{
+				if (weights[i] == 0)
+				{
+					weights[i] = 1;
+					used++;
+				}
+			}
+
+			typedef std::pair<std::uint64_t, int> Node;
+			std::vector<int> parents(count * 2);
+			while (true)
+			{
+				std::priority_queue<Node, std::vector<Node>, std::greater<Node>> queue;
+				std::fill(parents.begin(), parents.end(), -1);
+				for (int i = 0; i < count; i++)
+					if (weights[i] != 0) queue.push(Node(weights[i], i));
+
+				int next = count;
+				while (queue.size() > 1)
+				{
+					Node a = queue.top(); queue.pop();
+					Node b = queue.top(); queue.pop();
+					parents[a.second] = next;
+					parents[b.second] = next;
+					queue.push(Node(a.first + b.first, next));
+					next++;
+				}
+
+				int deepest = 0;
+				for (int i = 0; i < count; i++)
+				{
+					int length = 0;
+					if (weights[i] != 0)
+						for (int node = i; parents[node] != -1; node = parents[node]) length++;
+					lengths[i] = static_cast<std::uint8_t>(length);
+					deepest = std::max(deepest, length);
+				}
+
+				if (deepest <= maxBits) return;
+				for (auto &w : weights) if (w != 0) w = (w + 1) / 2;
+			}
+		}
+
+		// Turns code lengths into canonical Huffman codes, bit-reversed since deflate writes them starting from the top bit.
+		inline void buildHuffmanCodes(const std::uint8_t *lengths, int count, std::uint16_t *codes)
+		{
+			int lengthCounts[16] = { 0 };
+			for (int i = 0; i < count; i++) lengthCounts[lengths[i]]++;
+			lengthCounts[0] = 0;
+
+			int nextCode[16] = { 0 };
+			int code = 0;
+			for (int bits = 1; bits < 16; bits++)
+			{
+				code = (code + lengthCounts[bits - 1]) << 1;
+				nextCode[bits] = code;
+			}
+
+			for (int i = 0; i < count; i++)
+			{
+				int length = lengths[i];
+				codes[i] = 0;
+				if (length == 0) continue;
+
+				int value = nextCode[length]++;
+				int reversed = 0;
+				for (int bit = 0; bit < length; bit++)
+					reversed |= ((value >> bit) & 1) << (length - 1 - bit);
+				codes[i] = static_cast<std::uint16_t>(reversed);
+			}
+		}
+
+
+
+		inline DeflateEncoder::DeflateEncoder(PNGCompression compression, int runDistance) : compression(compression), runDistance(runDistance), headerWritten(false), adlerA(1), adlerB(0), bitBuffer(0), bitCount(0), windowStart(0), hashed(0)
+		{
+			lengthCodes.fill(0);
+			for (int code = 0; code < 28; code++)
+				for (int length = deflateLengthBases[code]; length < deflateLengthBases[code] + (1 << deflateLengthExtraBits[code]) && length < 258; length++)
+					lengthCodes[length] = static_cast<std::uint8_t>(code);
+			lengthCodes[258] = 28;							// 258 has its own code rather than being the last length of code 27
+
+			for (int code = 0; code < 30; code++)
+			{
+				int first = deflateDistanceBases[code];
+				int last = first + (1 << deflateDistanceExtraBits[code]) - 1;
+				for (int distance = first; distance <= last; distance++)
+				{
+					if (distance <= 256)
+						distanceCodes[distance - 1] = static_cast<std::uint8_t>(code);
+					else
+						distanceCodes[256 + ((distance - 1) >> 7)] = static_cast<std::uint8_t>(code);
+				}
+			}
+
+			if (compression == PNGCompression::Best)
+			{
+				hashHeads.assign(deflateWindowSize, deflateNoPosition);
+				hashChains.assign(deflateWindowSize, deflateNoPosition);
+			}
+		}
+
+		inline int DeflateEncoder::getLengthCode(int length) const
+		{
+			return lengthCodes[length];
+		}
+
+		inline int DeflateEncoder::getDistanceCode(int distance) const
+		{
+			return distance <= 256 ? distanceCodes[distance - 1] : distanceCodes[256 + ((distance - 1) >> 7)];
+		}
+
+		inline std::uint8_t DeflateEncoder::byteAt(std::size_t position) const
+		{
+			return window[position - windowStart];
+		}
+
+		inline void DeflateEncoder::writeBits(std::uint32_t bits, int count, std::vector<std::uint8_t> &out)
+		{
+			bitBuffer |= static_cast<std::uint64_t>(bits) << bitCount;
+			bitCount += count;
+			while (bitCount >= 8)
+			{
+				out.push_back(static_cast<std::uint8_t>(bitBuffer));
+				bitBuffer >>= 8;
+				bitCount -= 8;
+			}
+		}
+
+		inline void DeflateEncoder::alignToByte(std::vector<std::uint8_t> &out)
+		{
+			if (bitCount > 0)
+				out.push_back(static_cast<std::uint8_t>(bitBuffer));
+			bitBuffer = 0;
+			bitCount = 0;
+		}
+
+		inline void DeflateEncoder::compress(const std::uint8_t *data, std::size_t size, bool final, std::vector<std::uint8_t> &out)
+		{
+			if (headerWritten == false)
+			{
+				out.push_back(0x78);
+				out.push_back(compression == PNGCompression::Best ? 0xDA : 0x01);
+				headerWritten = true;
+			}
+
+			// Adler-32, with the modulo put off for as long as it can't overflow.
+			for (std::size_t done = 0; done < size;)
+			{
+				std::size_t chunk = std::min<std::size_t>(size - done, 5552);
+				for (std::size_t i = 0; i < chunk; i++)
+				{
+					adlerA += data[done + i];
+					adlerB += adlerA;
+				}
+				adlerA %= 65521;
+				adlerB %= 65521;
+				done += chunk;
+			}
+
+			if (size != 0 || final)
+			{
+				if (compression == PNGCompression::Store)
+				{
+					writeStoredBlock(data, size, final, out);
+				}
+				else
+				{
+					std::size_t start = windowStart + window.size();
+					window.insert(window.end(), data, data + size);
+
+					std::vector<Symbol> symbols;
+					findSymbols(start, start + size, symbols);
+					writeHuffmanBlock(symbols, data, size, final, out);
+
+					// Only the last 32kb can be referred back to.
+					if (window.size() > 4 * deflateWindowSize)
+					{
+						std::size_t drop = window.size() - deflateWindowSize;
+						window.erase(window.begin(), window.begin() + drop);
+						windowStart += drop;
+					}
+				}
+			}
+
+			if (final)
+			{
+				alignToByte(out);
+				std::uint32_t adler = (adlerB << 16) | adlerA;
+				out.push_back(static_cast<std::uint8_t>(adler >> 24));
+				out.push_back(static_cast<std::uint8_t>(adler >> 16));
+				out.push_back(static_cast<std::uint8_t>(adler >> 8));
+				out.push_back(static_cast<std::uint8_t>(adler));
+			}
+		}
+
+		inline void DeflateEncoder::writeStoredBlock(const std::uint8_t *data, std::size_t size, bool final, std::vector<std::uint8_t> &out)
+		{
+			std::size_t done = 0;
+			do
+			{
+				std::size_t length = std::min<std::size_t>(size - done, 0xFFFF);
+				bool last = done + length == size;
+
+				writeBits(final && last ? 1 : 0, 1, out);
+				writeBits(0, 2, out);
+				alignToByte(out);
+				out.push_back(static_cast<std::uint8_t>(length));
+				out.push_back(static_cast<std::uint8_t>(length >> 8));
+				out.push_back(static_cast<std::uint8_t>(~length));
+				out.push_back(static_cast<std::uint8_t>(~length >> 8));
+				out.insert(out.end(), data + done, data + done + length);
+
+				done += length;
+			} while (done < size);
+		}
+
+		inline int DeflateEncoder::findMatch(std::size_t position, std::size_t end, int &distance)
+		{
+			int maxLength = static_cast<int>(std::min<std::size_t>(deflateMaxMatch, end - position));
+			if (maxLength < 3) return 0;
+
+			const std::uint8_t *current = &window[position - windowStart];
+			int bestLength = 0;
+
+			if (compression == PNGCompression::Fast)
+			{
+				// Only look one byte and one pixel back, which catches runs of a single color and of repeated pixels.
+				int candidates[2] = { 1, runDistance };
+				for (int c = 0; c < (runDistance == 1 ? 1 : 2); c++)
+				{
+					std::size_t d = static_cast<std::size_t>(candidates[c]);
+					if (position < windowStart + d) continue;
+
+					const std::uint8_t *earlier = current - d;
+					int length = 0;
+					while (length < maxLength && earlier[length] == current[length]) length++;
+					if (length > bestLength)
+					{
+						bestLength = length;
+						distance = candidates[c];
+					}
+				}
+			}
+			else
+			{
+				auto hashAt = [&](std::size_t p)
+				{
+					const std::uint8_t *bytes = &window[p - windowStart];
+					return ((bytes[0] << 10) ^ (bytes[1] << 5) ^ bytes[2]) & (deflateWindowSize - 1);
+				};
+
+				for (; hashed < position && hashed + 2 < end; hashed++)
+				{
+					int hash = hashAt(hashed);
+					hashChains[hashed & (deflateWindowSize - 1)] = hashHeads[hash];
+					hashHeads[hash] = hashed;
+				}
+
+				std::size_t candidate = hashHeads[hashAt(position)];
+				for (int chain = 0; chain < deflateMaxChain; chain++)
+				{
+					if (candidate == deflateNoPosition || candidate >= position || candidate < windowStart || position - candidate > deflateWindowSize)
+						break;
+
+					const std::uint8_t *earlier = &window[candidate - windowStart];
+					if (earlier[bestLength] == current[bestLength])
+					{
+						int length = 0;
+						while (length < maxLength && earlier[length] == current[length]) length++;
+						if (length > bestLength)
+						{
+							bestLength = length;
+							distance = static_cast<int>(position - candidate);
+							if (length == maxLength) break;
+						}
+					}
+
+					std::size_t next = hashChains[candidate & (deflateWindowSize - 1)];
+					if (next >= candidate && next != deflateNoPosition) break;		// Overwritten by a newer position, so the chain ends here.
+					candidate = next;
+				}
+			}
+
+			return bestLength >= 3 ? bestLength : 0;
+		}
+
+		inline void DeflateEncoder::findSymbols(std::size_t start, std::size_t end, std::vector<Symbol> &symbols)
+		{
+			std::size_t position = start;
+			while (position < end)
+			{
+				int distance = 0;
+				int length = findMatch(position, end, distance);
+
+				// Best also checks if waiting a byte gives a longer match.
+				if (compression == PNGCompression::Best && length >= 3 && length < deflateMaxMatch && position + 1 < end)
+				{
+					int nextDistance = 0;
+					int nextLength = findMatch(position + 1, end, nextDistance);
+					if (nextLength > length) length = 0;
+				}
+
+				if (length >= 3)
+				{
+					Symbol symbol = { static_cast<std::uint16_t>(length), static_cast<std::uint16_t>(distance) };
+					symbols.push_back(symbol);
+					position += length;
+				}
+				else
+				{
+					Symbol symbol = { byteAt(position), 0 };
+					symbols.push_back(symbol);
+					position++;
+				}
+			}
+		}
+
+		inline void DeflateEncoder::writeHuffmanBlock(const std::vector<Symbol> &symbols, const std::uint8_t *data, std::size_t size, bool final, std::vector<std::uint8_t> &out)
+		{
+			std::uint32_t literalFrequencies[286] = { 0 };
+			std::uint32_t distanceFrequencies[30] = { 0 };
+			for (auto &symbol : symbols)
+			{
+				if (symbol.distance == 0)
+				{
+					literalFrequencies[symbol.value]++;
+				}
+				else
+				{
+					literalFrequencies[257 + getLengthCode(symbol.value)]++;
+					distanceFrequencies[getDistanceCode(symbol.distance)]++;
+				}
+			}
+			literalFrequencies[256]++;
+
+			std::uint8_t literalLengths[286], distanceLengths[30];
+			buildHuffmanLengths(literalFrequencies, 286, 15, literalLengths);
+			buildHuffmanLengths(distanceFrequencies, 30, 15, distanceLengths);
+
+			int literalCount = 286, distanceCount = 30;
+			while (literalCount > 257 && literalLengths[literalCount - 1] == 0) literalCount--;
+			while (distanceCount > 1 && distanceLengths[distanceCount - 1] == 0) distanceCount--;
+
+			// Both sets of lengths are sent as one list, run-length encoded with code length symbols 16 (repeat the last length), 17 and 18 (runs of 0s).
+			std::vector<std::uint8_t> allLengths(literalLengths, literalLengths + literalCount);
+			allLengths.insert(allLengths.end(), distanceLengths, distanceLengths + distanceCount);
+
+			std::vector<std::pair<std::uint8_t, std::uint8_t>> lengthSymbols;		// Symbol and extra bits
+			for (std::size_t i = 0; i < allLengths.size();)
+			{
+				std::uint8_t value = allLengths[i];
+				std::size_t run = 1;
+				while (i + run < allLengths.size() && allLengths[i + run] == value) run++;
+				i += run;
+
+				if (value == 0)
+				{
+					while (run >= 11)
+					{
+						std::size_t r = std::min<std::size_t>(run, 138);
+						lengthSymbols.push_back(std::make_pair(18, static_cast<std::uint8_t>(r - 11)));
+						run -= r;
+					}
+					if (run >= 3)
+					{
+						lengthSymbols.push_back(std::make_pair(17, static_cast<std::uint8_t>(run - 3)));
+						run = 0;
+					}
+				}
+				else
+				{
+					lengthSymbols.push_back(std::make_pair(value, 0));
+					run--;
+					while (run >= 3)
+					{
+						std::size_t r = std::min<std::size_t>(run, 6);
+						lengthSymbols.push_back(std::make_pair(16, static_cast<std::uint8_t>(r - 3)));
+						run -= r;
+					}
+				}
+				for (; run > 0; run--)
+					lengthSymbols.push_back(std::make_pair(value, 0));
+			}
+
+			std::uint32_t codeLengthFrequencies[19] = { 0 };
+			for (auto &s : lengthSymbols) codeLengthFrequencies[s.first]++;
+			std::uint8_t codeLengthLengths[19];
+			buildHuffmanLengths(codeLengthFrequencies, 19, 7, codeLengthLengths);
+
+			int codeLengthCount = 19;
+			while (codeLengthCount > 4 && codeLengthLengths[deflateCodeLengthOrder[codeLengthCount - 1]] == 0) codeLengthCount--;
+
+			// If the data didn't compress, storing it is smaller.
+			const int codeLengthExtraBits[3] = { 2, 3, 7 };
+			std::uint64_t cost = 3 + 14 + codeLengthCount * 3;
+			for (auto &s : lengthSymbols) cost += codeLengthLengths[s.first] + (s.first >= 16 ? codeLengthExtraBits[s.first - 16] : 0);
+			for (int i = 0; i < 286; i++) cost += static_cast<std::uint64_t>(literalFrequencies[i]) * (literalLengths[i] + (i >= 257 ? deflateLengthExtraBits[i - 257] : 0));
+			for (int i = 0; i < 30; i++) cost += static_cast<std::uint64_t>(distanceFrequencies[i]) * (distanceLengths[i] + deflateDistanceExtraBits[i]);
+
+			std::uint64_t storedCost = static_cast<std::uint64_t>(size) * 8 + (size / 0xFFFF + 1) * 40 + 7;
+			if (storedCost < cost)
+			{
+				writeStoredBlock(data, size, final, out);
+				return;
+			}
+
+			std::uint16_t literalCodes[286], distanceCodesOut[30], codeLengthCodes[19];
+			buildHuffmanCodes(literalLengths, 286, literalCodes);
+			buildHuffmanCodes(distanceLengths, 30, distanceCodesOut);
+			buildHuffmanCodes(codeLengthLengths, 19, codeLengthCodes);
+
+			writeBits(final ? 1 : 0, 1, out);
+			writeBits(2, 2, out);
+			writeBits(literalCount - 257, 5, out);
+			writeBits(distanceCount - 1, 5, out);
+			writeBits(codeLengthCount - 4, 4, out);
+			for (int i = 0; i < codeLengthCount; i++)
+				writeBits(codeLengthLengths[deflateCodeLengthOrder[i]], 3, out);
+			for (auto &s : lengthSymbols)
+			{
+				writeBits(codeLengthCodes[s.first], codeLengthLengths[s.first], out);
+				if (s.first >= 16) writeBits(s.second, codeLengthExtraBits[s.first - 16], out);
+			}
+
+			for (auto &symbol : symbols)
+			{
+				if (symbol.distance == 0)
+				{
+					writeBits(literalCodes[symbol.value], literalLengths[symbol.value], out);
+				}
+				else
+				{
+					int lengthCode = getLengthCode(symbol.value);
+					writeBits(literalCodes[257 + lengthCode], literalLengths[257 + lengthCode], out);
+					writeBits(symbol.value - deflateLengthBases[lengthCode], deflateLengthExtraBits[lengthCode], out);
+
+					int distanceCode = getDistanceCode(symbol.distance);
+					writeBits(distanceCodesOut[distanceCode], distanceLengths[distanceCode], out);
+					writeBits(symbol.distance - deflateDistanceBases[distanceCode], deflateDistanceExtraBits[distanceCode], out);
+				}
+			}
+			writeBits(literalCodes[256], literalLengths[256], out);
+		}
+
+		const std::size_t pngCompressionBlockSize = 0x20000;			// How much filtered image data is collected before it's compressed
+		const std::size_t pngMaxIDATSize = 0x10000;
+	}
+
+
+
+	template <typename outputIteratorType>
+	PNGWriter<outputIteratorType>::PNGWriter(outputIteratorType out, int width, int height, PNGCompression compression) : out(out), width(width), height(height), rowsWritten(0), indexed(false), finished(false), compression(compression), bytesPerPixel(4), encoder(compression, 4)
+	{
+		writeHeader(std::vector<std::uint32_t>());
+	}
+
+	template <typename outputIteratorType>
+	template <typename paletteIteratorType>
+	PNGWriter<outputIteratorType>::PNGWriter(outputIteratorType out, int width, int height, paletteIteratorType paletteStart, paletteIteratorType paletteEnd, PNGCompression compression) : out(out), width(width), height(height), rowsWritten(0), indexed(true), finished(false), compression(compression), bytesPerPixel(1), encoder(compression, 1)
+	{
+		std::vector<std::uint32_t> palette;
+		for (; paletteStart != paletteEnd; ++paletteStart)
+		{
+			palette.push_back(static_cast<std::uint32_t>(*paletteStart));
+			if (palette.size() > 256)
+				throw std::runtime_error("PNG palettes can't have more than 256 colors.");
+		}
+		if (palette.empty())
+			throw std::runtime_error("PNG palette is empty.");
+
+		writeHeader(palette);
+	}
+
+	template <typename outputIteratorType>
+	void PNGWriter<outputIteratorType>::writeHeader(const std::vector<std::uint32_t> &palette)
+	{
+		if (width <= 0 || height <= 0)
+			throw std::runtime_error("PNG width and height must be greater than 0.");
+
+		for (std::uint32_t n = 0; n < 256; n++)
+		{
+			std::uint32_t c = n;
+			for (int k = 0; k < 8; k++)
+				c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+			crcTable[n] = c;
+		}
+
+		const std::uint8_t signature[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+		for (auto b : signature) *(out++) = b;
+
+		std::uint8_t header[13] =
+		{
+			static_cast<std::uint8_t>(width >> 24), static_cast<std::uint8_t>(width >> 16), static_cast<std::uint8_t>(width >> 8), static_cast<std::uint8_t>(width),
+			static_cast<std::uint8_t>(height >> 24), static_cast<std::uint8_t>(height >> 16), static_cast<std::uint8_t>(height >> 8), static_cast<std::uint8_t>(height),
+			8,					// Bit depth
+			static_cast<std::uint8_t>(indexed ? 3 : 6),	// Palette or RGBA
+			0, 0, 0					// Deflate, standard filters, not interlaced
+		};
+		writeChunk("IHDR", header, sizeof(header));
+
+		if (indexed)
+		{
+			std::vector<std::uint8_t> colors, alphas;
+			for (auto c : palette)
+			{
+				colors.push_back(static_cast<std::uint8_t>(c >> 16));
+				colors.push_back(static_cast<std::uint8_t>(c >> 8));
+				colors.push_back(static_cast<std::uint8_t>(c));
+				alphas.push_back(static_cast<std::uint8_t>(c >> 24));
+			}
+			writeChunk("PLTE", colors.data(), colors.size());
+
+			while (alphas.empty() == false && alphas.back() == 0xFF) alphas.pop_back();
+			if (alphas.empty() == false)
+				writeChunk("tRNS", alphas.data(), alphas.size());
+		}
+
+		previousRow.assign(width * bytesPerPixel, 0);
+	}
+
+	template <typename outputIteratorType>
+	void PNGWriter<outputIteratorType>::writeChunk(const char *type, const std::uint8_t *data, std::size_t size)
+	{
+		std::uint32_t length = static_cast<std::uint32_t>(size);
+		*(out++) = static_cast<std::uint8_t>(length >> 24);
+		*(out++) = static_cast<std::uint8_t>(length >> 16);
+		*(out++) = static_cast<std::uint8_t>(length >> 8);
+		*(out++) = static_cast<std::uint8_t>(length);
+
+		std::uint32_t crc = 0xFFFFFFFF;
+		for (int i = 0; i < 4; i++)
+		{
+			std::uint8_t b = static_cast<std::uint8_t>(type[i]);
+			crc = crcTable[(crc ^ b) & 0xFF] ^ (crc >> 8);
+			*(out++) = b;
+		}
+		for (std::size_t i = 0; i < size; i++)
+		{
+			crc = crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+			*(out++) = data[i];
+		}
+		crc ^= 0xFFFFFFFF;
+
+		*(out++) = static_cast<std::uint8_t>(crc >> 24);
+		*(out++) = static_cast<std::uint8_t>(crc >> 16);
+		*(out++) = static_cast<std::uint8_t>(crc >> 8);
+		*(out++) = static_cast<std::uint8_t>(crc);
+	}
+
+	template <typename outputIteratorType>
+	void PNGWriter<outputIteratorType>::flushCompressed(bool everything)
+	{
+		std::size_t done = 0;
+		while (compressed.size() - done >= internal::pngMaxIDATSize || (everything && done < compressed.size()))
+		{
+			std::size_t size = std::min(compressed.size() - done, internal::pngMaxIDATSize);
+			writeChunk("IDAT", compressed.data() + done, size);
+			done += size;
+		}
+		compressed.erase(compressed.begin(), compressed.begin() + done);
+	}
+
+	template <typename outputIteratorType>
+	void PNGWriter<outputIteratorType>::filterRow()
+	{
+		std::size_t rowSize = currentRow.size();
+		auto filter = [&](int type, std::uint8_t *result)
+		{
+			for (std::size_t i = 0; i < rowSize; i++)
+			{
+				int left = i >= (std::size_t)bytesPerPixel ? currentRow[i - bytesPerPixel] : 0;
+				int up = previousRow[i];
+				int upLeft = i >= (std::size_t)bytesPerPixel ? previousRow[i - bytesPerPixel] : 0;
+				int predicted = 0;
+				switch (type)
+				{
+				case 1: predicted = left; break;
+				case 2: predicted = up; break;
+				case 3: predicted = (left + up) / 2; break;
+				case 4:
+				{
+					int p = left + up - upLeft;
+					int pa = std::abs(p - left), pb = std::abs(p - up), pc = std::abs(p - upLeft);
+					predicted = (pa <= pb && pa <= pc) ? left : (pb <= pc ? up : upLeft);
+					break;
+				}
+				}
+				result[i] = static_cast<std::uint8_t>(currentRow[i] - predicted);
+			}
+		};
+
+		// Palette images are left unfiltered, since differences between indices don't mean anything.  Otherwise Fast uses Up, which turns rows that repeat the one above into runs of 0s.
+		int type = 0;
+		if (indexed == false && compression == PNGCompression::Fast) type = 2;
+
+		std::size_t start = pending.size();
+		pending.resize(start + 1 + rowSize);
+		if (indexed == false && compression == PNGCompression::Best)
+		{
+			// Pick whichever filter gives the smallest sum of differences, the usual guess at what will compress best.
+			filterScratch.resize(rowSize);
+			std::uint64_t bestScore = ~0ULL;
+			for (int t = 0; t < 5; t++)
+			{
+				filter(t, filterScratch.data());
+				std::uint64_t score = 0;
+				for (auto b : filterScratch) score += std::abs(static_cast<std::int8_t>(b));
+				if (score < bestScore)
+				{
+					bestScore = score;
+					type = t;
+					std::copy(filterScratch.begin(), filterScratch.end(), pending.begin() + start + 1);
+				}
+			}
+		}
+		else
+		{
+			filter(type, pending.data() + start + 1);
+		}
+		pending[start] = static_cast<std::uint8_t>(type);
+	}
+
+	template <typename outputIteratorType>
+	template <typename inputIteratorType>
+	void PNGWriter<outputIteratorType>::writeRow(inputIteratorType rowStart, inputIteratorType rowEnd)
+	{
+		if (finished || rowsWritten >= height)
+			throw std::runtime_error("Every row of the PNG has already been written.");
+
+		currentRow.clear();
+		int pixels = 0;
+		for (; rowStart != rowEnd; ++rowStart)
+		{
+			if (++pixels > width)
+				throw std::runtime_error("PNG row is wider than the image.");
+
+			if (indexed)
+			{
+				currentRow.push_back(static_cast<std::uint8_t>(*rowStart));
+			}
+			else
+			{
+				std::uint32_t color = static_cast<std::uint32_t>(*rowStart);
+				currentRow.push_back(static_cast<std::uint8_t>(color >> 16));
+				currentRow.push_back(static_cast<std::uint8_t>(color >> 8));
+				currentRow.push_back(static_cast<std::uint8_t>(color));
+				currentRow.push_back(static_cast<std::uint8_t>(color >> 24));
+			}
+		}
+		if (pixels != width)
+			throw std::runtime_error("PNG row is narrower than the image.");
+
+		filterRow();
+		std::swap(currentRow, previousRow);
+		rowsWritten++;
+
+		if (pending.size() >= internal::pngCompressionBlockSize)
+		{
+			encoder.compress(pending.data(), pending.size(), false, compressed);
+			pending.clear();
+			flushCompressed(false);
+		}
+	}
+
+	template <typename outputIteratorType>
+	int PNGWriter<outputIteratorType>::getRowsWritten() const
+	{
+		return rowsWritten;
+	}
+
+	template <typename outputIteratorType>
+	outputIteratorType PNGWriter<outputIteratorType>::finish()
+	{
+		if (finished)
+			throw std::runtime_error("PNG has already been finished.");
+		if (rowsWritten != height)
+			throw std::runtime_error("Not every row of the PNG has been written.");
+
+		encoder.compress(pending.data(), pending.size(), true, compressed);
+		pending.clear();
+		flushCompressed(true);
+		writeChunk("IEND", nullptr, 0);
+		finished = true;
+		return out;
+	}
+
+	template <typename outputIteratorType>
+	PNGWriter<outputIteratorType> makePNGWriter(outputIteratorType out, int width, int height, PNGCompression compression)
+	{
+		return PNGWriter<outputIteratorType>(out, width, height, compression);
+	}
+
+	template <typename outputIteratorType, typename paletteIteratorType>
+	PNGWriter<outputIteratorType> makeIndexedPNGWriter(outputIteratorType out, int width, int height, paletteIteratorType paletteStart, paletteIteratorType paletteEnd, PNGCompression compression)
+	{
+		return PNGWriter<outputIteratorType>(out, width, height, paletteStart, paletteEnd, compression);
+	}
+
+	namespace internal
+	{
+		template <typename valueType, typename inputIteratorType, typename outputIteratorType>
+		outputIteratorType writeWholePNG(PNGWriter<outputIteratorType> &writer, inputIteratorType start, inputIteratorType end, int width, int height)
+		{
+			std::vector<valueType> row(width);
+			for (int y = 0; y < height; y++)
+			{
+				for (int x = 0; x < width; x++)
+				{
+					if (start == end)
+						throw std::runtime_error("Image has fewer pixels than its width times its height.");
+					row[x] = static_cast<valueType>(*start);
+					++start;
+				}
+				writer.writeRow(row.begin(), row.end());
+			}
+			if (start != end)
+				throw std::runtime_error("Image has more pixels than its width times its height.");
+
+			return writer.finish();
+		}
+	}
+
+	template <typename inputIteratorType, typename outputIteratorType>
+	outputIteratorType writePNG(inputIteratorType pixelsStart, inputIteratorType pixelsEnd, int width, int height, outputIteratorType out, PNGCompression compression)
+	{
+		PNGWriter<outputIteratorType> writer(out, width, height, compression);
+		return internal::writeWholePNG<std::uint32_t>(writer, pixelsStart, pixelsEnd, width, height);
+	}
+
+	template <typename inputIteratorType, typename paletteIteratorType, typename outputIteratorType>
+	outputIteratorType writeIndexedPNG(inputIteratorType indicesStart, inputIteratorType indicesEnd, int width, int height, paletteIteratorType paletteStart, paletteIteratorType paletteEnd, outputIteratorType out, PNGCompression compression)
+	{
+		PNGWriter<outputIteratorType> writer(out, width, height, paletteStart, paletteEnd, compression);
+		return internal::writeWholePNG<std::uint8_t>(writer, indicesStart, indicesEnd, width, height);
+	}
+}
@@ -3,6 +3,7 @@
 #include <cctype>
 
 #include "asardll.hpp"
+#include "Tracing.hpp"
 
 
 namespace worldlib
@@ -99,6 +100,8 @@ namespace worldlib
 	template <typename stringType, typename romDataType, typename errorDataOutputIteratorType, typename warningDataOutputIteratorType, typename labelDataOutputIteratorType, typename defineDataOutputIteratorType>
 	bool patchToROM(const char *patchFilepath, const romDataType *romDataType, int romSize, errorDataOutputIteratorType &errorDataOutput, warningDataOutputIteratorType &warningDataOutput, labelDataOutputIteratorType &labelDataOutput, defineDataOutputIteratorType &defineDataOutput)
 	{
+		WORLDLIB_TRACE("patchToROM");
+
 		if (asar_init() == false) { throw std::runtime_error("Could not load asar.dll"); }
 
 		int resultingLength = romSize;
@@ -0,0 +1,122 @@
+#pragma once
+#include <type_traits>
+
+namespace worldlib
+{
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file Result.hpp
+/// \brief Contains the error codes and result type returned by the non-throwing (try...) versions of functions.
+///
+/// \addtogroup SFC
+///  @{
+//////////////////////////////////////////////////////////////////////////////
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief Why a try... function failed.  Each one matches the std::runtime_error the throwing version of the function would have thrown.
+	////////////////////////////////////////////////////////////
+	enum class ErrorCode : int
+	{
+		None = 0,				///< No error
+		ROMTooSmall = 1,			///< The ROM is too small to have an internal header
+		UnmappableSFCAddress = 2,		///< The SFC address can't be converted to a PC one (it's not 24-bit, or it's WRAM or hardware registers)
+		AddressOutOfBounds = 3,			///< The address is past the end of the ROM
+		InvalidGraphicsFile = 4,		///< There's no such thing as this graphics file number
+		MissingGraphicsFile = 5,		///< The graphics file number is valid, but the ROM doesn't have that file
+		UnexpectedEndOfData = 6,		///< Compressed data ended partway through a command
+		UnknownCompressionCommand = 7,		///< Compressed data has a command that doesn't exist
+		InvalidBackReference = 8,		///< Compressed data copies from a place that hasn't been decompressed yet
+		UnrecognizedCompressionFormat = 9	///< The ROM says it uses a compression format other than LZ2 or LZ3
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief Returns the message the throwing version of a function puts in its std::runtime_error for this error
+	////////////////////////////////////////////////////////////
+	inline const char *getErrorMessage(ErrorCode error) noexcept;
+
+	namespace internal
+	{
+		// Holds a Result's value, which is only constructed if there is one, since output iterators like std::back_insert_iterator can't be default-constructed.
+		// For trivially copyable values (ints, most iterators) this is trivially copyable too, so Results can be returned in registers like a plain int.
+		template <typename valueType, bool trivial = std::is_trivially_copyable<valueType>::value>
+		struct ResultStorage
+		{
+			typename std::aligned_storage<sizeof(valueType), std::alignment_of<valueType>::value>::type storage;
+			ErrorCode errorCode;
+		};
+
+		template <typename valueType>
+		struct ResultStorage<valueType, false>
+		{
+			typename std::aligned_storage<sizeof(valueType), std::alignment_of<valueType>::value>::type storage;
+			ErrorCode errorCode;
+
+			ResultStorage() {}
+			ResultStorage(const ResultStorage &other);
+			ResultStorage &operator=(const ResultStorage &other);
+			~ResultStorage();
+		};
+	}
+
+	////////////////////////////////////////////////////////////
+	/// \brief Either a value or the reason there isn't one.  Returned by the try... functions, which never throw for bad ROM data.
+	/// \details Check it with ok() (or just as a bool) before calling value().
+	/// \code
+	/// auto address = worldlib::trySFCToPC(romStart, romEnd, snesAddress);
+	/// if (!address) return address.error();
+	/// use(address.value());
+	/// \endcode
+	////////////////////////////////////////////////////////////
+	template <typename valueType>
+	class Result : private internal::ResultStorage<valueType>
+	{
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Creates a successful result
+		////////////////////////////////////////////////////////////
+		Result(const valueType &value);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Creates a failed result.  error shouldn't be ErrorCode::None.
+		////////////////////////////////////////////////////////////
+		Result(ErrorCode error) noexcept;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns true if there's a value
+		////////////////////////////////////////////////////////////
+		bool ok() const noexcept;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Same as ok()
+		////////////////////////////////////////////////////////////
+		explicit operator bool() const noexcept;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns why there's no value, or ErrorCode::None if there is one
+		////////////////////////////////////////////////////////////
+		ErrorCode error() const noexcept;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the value
+		///
+		/// \throws std::runtime_error There's no value.  The message is getErrorMessage(error()), so this is how the throwing functions are written.
+		////////////////////////////////////////////////////////////
+		const valueType &value() const;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Returns the value, or fallback if there isn't one
+		////////////////////////////////////////////////////////////
+		valueType valueOr(const valueType &fallback) const;
+
+	private:
+		const valueType *pointer() const noexcept;
+	};
+
+
+//////////////////////////////////////////////////////////////////////////////
+///  @}
+//////////////////////////////////////////////////////////////////////////////
+}
+
+#include "Result.inl"
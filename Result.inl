@@ -0,0 +1,121 @@
+#include "Internal.hpp"
+#include <new>
+#include <stdexcept>
+
+namespace worldlib
+{
+	inline const char *getErrorMessage(ErrorCode error) noexcept
+	{
+		switch (error)
+		{
+		case ErrorCode::None:				return "No error.";
+		case ErrorCode::ROMTooSmall:			return "ROM is too small!";
+		case ErrorCode::UnmappableSFCAddress:		return "SFC address cannot be mapped to a PC one.";
+		case ErrorCode::AddressOutOfBounds:		return "Address is out of bounds for the current ROM.";
+		case ErrorCode::InvalidGraphicsFile:		return "ExGFX file is not valid.";
+		case ErrorCode::MissingGraphicsFile:		return "ExGFX file does not exist.";
+		case ErrorCode::UnexpectedEndOfData:		return "Unexpected end reached.";
+		case ErrorCode::UnknownCompressionCommand:	return "Unknown command bit sequence.";
+		case ErrorCode::InvalidBackReference:		return "Compressed data refers to data that hasn't been decompressed yet.";
+		case ErrorCode::UnrecognizedCompressionFormat:	return "Unrecognized compression format.";
+		default:					return "Unknown error.";
+		}
+	}
+
+	namespace internal
+	{
+		template <typename valueType>
+		ResultStorage<valueType, false>::ResultStorage(const ResultStorage &other) : errorCode(other.errorCode)
+		{
+			if (errorCode == ErrorCode::None) new (&storage) valueType(*reinterpret_cast<const valueType *>(&other.storage));
+		}
+
+		template <typename valueType>
+		ResultStorage<valueType, false> &ResultStorage<valueType, false>::operator=(const ResultStorage &other)
+		{
+			if (this == &other) return *this;
+
+			// errorCode only says there's a value once there really is one, so if copying the value throws, this is left as a valid Result (like std::optional).
+			if (errorCode == ErrorCode::None && other.errorCode == ErrorCode::None)
+			{
+				*reinterpret_cast<valueType *>(&storage) = *reinterpret_cast<const valueType *>(&other.storage);
+			}
+			else if (other.errorCode == ErrorCode::None)
+			{
+				new (&storage) valueType(*reinterpret_cast<const valueType *>(&other.storage));
+				errorCode = ErrorCode::None;
+			}
+			else
+			{
+				if (errorCode == ErrorCode::None) reinterpret_cast<valueType *>(&storage)->~valueType();
+				errorCode = other.errorCode;
+			}
+			return *this;
+		}
+
+		template <typename valueType>
+		ResultStorage<valueType, false>::~ResultStorage()
+		{
+			if (errorCode == ErrorCode::None) reinterpret_cast<valueType *>(&storage)->~valueType();
+		}
+	}
+
+	template <typename valueType>
+	Result<valueType>::Result(const valueType &value)
+	{
+		this->errorCode = ErrorCode::None;
+		new (&this->storage) valueType(value);
+	}
+
+	template <typename valueType>
+	Result<valueType>::Result(ErrorCode error) noexcept
+	{
+		this->errorCode = error;
+	}
+
+	template <typename valueType>
+	bool Result<valueType>::ok() const noexcept
+	{
+		return this->errorCode == ErrorCode::None;
+	}
+
+	template <typename valueType>
+	Result<valueType>::operator bool() const noexcept
+	{
+		return ok();
+	}
+
+	template <typename valueType>
+	ErrorCode Result<valueType>::error() const noexcept
+	{
+		return this->errorCode;
+	}
+
+	namespace internal
+	{
+		// Kept out of Result::value so the check that's always done stays small enough to inline.
+		inline void throwError(ErrorCode error)
+		{
+			throw std::runtime_error(getErrorMessage(error));
+		}
+	}
+
+	template <typename valueType>
+	const valueType &Result<valueType>::value() const
+	{
+		if (!ok()) internal::throwError(this->errorCode);
+		return *pointer();
+	}
+
+	template <typename valueType>
+	valueType Result<valueType>::valueOr(const valueType &fallback) const
+	{
+		return ok() ? *pointer() : fallback;
+	}
+
+	template <typename valueType>
+	const valueType *Result<valueType>::pointer() const noexcept
+	{
+		return reinterpret_cast<const valueType *>(&this->storage);
+	}
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include "Result.hpp"
 
 namespace worldlib
 {
@@ -72,6 +73,20 @@ namespace worldlib
 	////////////////////////////////////////////////////////////
 	inline std::uint32_t SFCToARGB(std::uint16_t color);
 
+	////////////////////////////////////////////////////////////
+	/// \ingroup SFC
+	/// \brief Converts a whole range of colors in SFC format into ARGB format.  Same result as calling SFCToARGB on each color.
+	///
+	/// \param colorsStart		An iterator pointing to the start of the SFC colors to convert
+	/// \param colorsEnd		An iterator pointing to the end of the SFC colors to convert
+	/// \param out			Where to output the ARGB colors
+	///
+	/// \return Iterator pointing to the end of your color data
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType, typename outputIteratorType>
+	outputIteratorType SFCToARGB(inputIteratorType colorsStart, inputIteratorType colorsEnd, outputIteratorType out);
+
 	////////////////////////////////////////////////////////////
 	/// \ingroup SFC
 	/// \brief Converts an color in ARGB format and turns it into SFC format.
@@ -174,6 +189,24 @@ namespace worldlib
 	////////////////////////////////////////////////////////////
 	template <typename inputIteratorType> std::uint32_t readTrivigintetSFC(inputIteratorType romStart, inputIteratorType romEnd, int offset);
 
+	////////////////////////////////////////////////////////////
+	/// \ingroup SFC
+	/// \brief Get several consecutive two-byte values starting at an address in SFC format, correctly de-endianated.
+	/// \details Same as calling readWordSFC count times, but the address is only converted once as long as the data doesn't cross a bank boundary.
+	///
+	/// \param romStart		An iterator pointing to the start of the ROM data
+	/// \param romEnd		An iterator pointing to the end of the ROM data
+	/// \param offset		The address to start getting the data from
+	/// \param count		How many 16-bit values to get
+	/// \param out			Where to output the data
+	///
+	/// \return Iterator pointing to the end of your data
+	///
+	/// \throws std::runtime_error The address given could not be converted a valid PC address, or the address does not exist in the ROM.
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType, typename outputIteratorType> outputIteratorType readWordsSFC(inputIteratorType romStart, inputIteratorType romEnd, int offset, int count, outputIteratorType out);
+
 	////////////////////////////////////////////////////////////
 	/// \ingroup SFC
 	/// \brief Returns the game's title in the ROM header (not 0x200 byte header at the start).
@@ -219,6 +252,64 @@ namespace worldlib
 	////////////////////////////////////////////////////////////
 	template <typename inputIteratorType> inputIteratorType getROMStart(inputIteratorType dataStart, inputIteratorType dataEnd);
 
+	////////////////////////////////////////////////////////////
+	/// \ingroup SFC
+	/// \brief Same as romUsesSA1, but returns ErrorCode::ROMTooSmall instead of throwing
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType>
+	Result<bool> tryROMUsesSA1(inputIteratorType romStart, inputIteratorType romEnd) noexcept;
+
+	////////////////////////////////////////////////////////////
+	/// \ingroup SFC
+	/// \brief Same as SFCToPC, but returns an error instead of throwing.  SFCToPC is a wrapper around this.
+	/// \details Use the try... functions when bad addresses are expected, e.g. when scanning lots of possibly broken ROMs, since they never pay for an exception.
+	///
+	/// \param romStart		An iterator pointing to the start of the ROM data
+	/// \param romEnd		An iterator pointing to the end of the ROM data
+	/// \param addr			The SFC address to convert
+	///
+	/// \return The PC address, or ErrorCode::UnmappableSFCAddress or ErrorCode::ROMTooSmall
+	///
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType>
+	inline Result<int> trySFCToPC(inputIteratorType romStart, inputIteratorType romEnd, int addr) noexcept;
+
+	////////////////////////////////////////////////////////////
+	/// \ingroup SFC
+	/// \brief Same as readBytePC, but returns ErrorCode::AddressOutOfBounds instead of throwing
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType> Result<std::uint8_t> tryReadBytePC(inputIteratorType romStart, inputIteratorType romEnd, int offset) noexcept;
+
+	////////////////////////////////////////////////////////////
+	/// \ingroup SFC
+	/// \brief Same as readWordPC, but returns ErrorCode::AddressOutOfBounds instead of throwing
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType> Result<std::uint16_t> tryReadWordPC(inputIteratorType romStart, inputIteratorType romEnd, int offset) noexcept;
+
+	////////////////////////////////////////////////////////////
+	/// \ingroup SFC
+	/// \brief Same as readTrivigintetPC, but returns ErrorCode::AddressOutOfBounds instead of throwing
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType> Result<std::uint32_t> tryReadTrivigintetPC(inputIteratorType romStart, inputIteratorType romEnd, int offset) noexcept;
+
+	////////////////////////////////////////////////////////////
+	/// \ingroup SFC
+	/// \brief Same as readByteSFC, but returns an error (see trySFCToPC and tryReadBytePC) instead of throwing
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType> Result<std::uint8_t> tryReadByteSFC(inputIteratorType romStart, inputIteratorType romEnd, int offset) noexcept;
+
+	////////////////////////////////////////////////////////////
+	/// \ingroup SFC
+	/// \brief Same as readWordSFC, but returns an error (see trySFCToPC and tryReadWordPC) instead of throwing
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType> Result<std::uint16_t> tryReadWordSFC(inputIteratorType romStart, inputIteratorType romEnd, int offset) noexcept;
+
+	////////////////////////////////////////////////////////////
+	/// \ingroup SFC
+	/// \brief Same as readTrivigintetSFC, but returns an error (see trySFCToPC and tryReadTrivigintetPC) instead of throwing
+	////////////////////////////////////////////////////////////
+	template <typename inputIteratorType> Result<std::uint32_t> tryReadTrivigintetSFC(inputIteratorType romStart, inputIteratorType romEnd, int offset) noexcept;
+
 //////////////////////////////////////////////////////////////////////////////
 ///  @}
 //////////////////////////////////////////////////////////////////////////////
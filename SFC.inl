@@ -1,17 +1,19 @@
 #include "Internal.hpp"
+#include "Instrumentation.hpp"
 #include <exception>
 
 namespace worldlib
 {
 
 	template <typename inputIteratorType>
-	bool romUsesSA1(inputIteratorType romStart, inputIteratorType romEnd)
+	Result<bool> tryROMUsesSA1(inputIteratorType romStart, inputIteratorType romEnd) noexcept
 	{
+		if (std::distance(romStart, romEnd) <= 0x7FD6) return ErrorCode::ROMTooSmall;
+
 		auto mapBytePos = romStart;
 		auto romBytePos = romStart;
 		std::advance(mapBytePos, 0x7FD5);
 		std::advance(romBytePos, 0x7FD6);
-		if (romBytePos >= romEnd) throw std::runtime_error("ROM is too small!");
 
 		// Behold the only place PC addresses are ever used (probably).
 		unsigned char mapByte = *(mapBytePos);
@@ -20,19 +22,37 @@ namespace worldlib
 	}
 
 	template <typename inputIteratorType>
-	inline int SFCToPC(inputIteratorType romStart, inputIteratorType romEnd, int addr)
+	bool romUsesSA1(inputIteratorType romStart, inputIteratorType romEnd)
+	{
+		return tryROMUsesSA1(romStart, romEnd).value();
+	}
+
+	template <typename inputIteratorType>
+	inline Result<int> trySFCToPC(inputIteratorType romStart, inputIteratorType romEnd, int addr) noexcept
 	{
+		WORLDLIB_INSTRUMENT(SFCToPC);
+
 		if (addr < 0 || addr > 0xFFFFFF ||		// not 24bit 
 		    (addr & 0xFE0000) == 0x7E0000 ||		// wram 
 		    (addr & 0x408000) == 0x000000)		// hardware regs 
-		    throw std::runtime_error("SFC address cannot be mapped to a PC one.");
+		    return ErrorCode::UnmappableSFCAddress;
+
+		auto sa1 = tryROMUsesSA1(romStart, romEnd);
+		if (!sa1) return sa1.error();
 
-		if (romUsesSA1(romStart, romEnd) && addr >= 0x808000)
+		if (sa1.value() && addr >= 0x808000)
 			addr -= 0x400000;
 		addr = ((addr & 0x7F0000) >> 1 | (addr & 0x7FFF));
 		return addr;
 	}
 
+	template <typename inputIteratorType>
+	inline int SFCToPC(inputIteratorType romStart, inputIteratorType romEnd, int addr)
+	{
+		WORLDLIB_INSTRUMENT(SFCToPC);		// Also here so exceptions thrown by the wrapper are counted
+		return trySFCToPC(romStart, romEnd, addr).value();
+	}
+
 
 	template <typename inputIteratorType>
 	inline int PCToSFC(inputIteratorType romStart, inputIteratorType romEnd, int addr)
@@ -65,6 +85,18 @@ namespace worldlib
 		return result;
 	}
 
+	template <typename inputIteratorType, typename outputIteratorType>
+	outputIteratorType SFCToARGB(inputIteratorType colorsStart, inputIteratorType colorsEnd, outputIteratorType out)
+	{
+		for (; colorsStart != colorsEnd; ++colorsStart)
+		{
+			std::uint32_t color = static_cast<std::uint16_t>(*colorsStart);
+			*(out++) = 0xFF000000 | ((color & 0x001F) << 19) | ((color & 0x03E0) << 6) | ((color & 0x7C00) >> 7);
+		}
+
+		return out;
+	}
+
 
 	inline std::uint16_t ARGBToSFC(std::uint32_t color)
 	{
@@ -77,45 +109,130 @@ namespace worldlib
 
 
 
-	template <typename inputIteratorType> std::uint8_t readBytePC(inputIteratorType romStart, inputIteratorType romEnd, int offset)
+	template <typename inputIteratorType> Result<std::uint8_t> tryReadBytePC(inputIteratorType romStart, inputIteratorType romEnd, int offset) noexcept
 	{
+		if (offset < 0 || std::distance(romStart, romEnd) <= offset)
+			return ErrorCode::AddressOutOfBounds;
 		std::advance(romStart, offset);
-		if (romStart >= romEnd)
-			throw std::runtime_error("Address is out of bounds for the current ROM.");
-		return *romStart;
+		return static_cast<std::uint8_t>(*romStart);
 	}
 
-	template <typename inputIteratorType> std::uint16_t readWordPC(inputIteratorType romStart, inputIteratorType romEnd, int offset)
+	template <typename inputIteratorType> Result<std::uint16_t> tryReadWordPC(inputIteratorType romStart, inputIteratorType romEnd, int offset) noexcept
 	{
-		auto byte1 = readBytePC(romStart, romEnd, offset + 0);
-		auto byte2 = readBytePC(romStart, romEnd, offset + 1);
+		if (offset < 0 || std::distance(romStart, romEnd) - 1 <= offset)
+			return ErrorCode::AddressOutOfBounds;
+		std::advance(romStart, offset);
 
-		return (byte2 << 8) | byte1;
+		std::uint8_t byte1 = *(romStart++);
+		std::uint8_t byte2 = *romStart;
+		return static_cast<std::uint16_t>((byte2 << 8) | byte1);
 	}
 
-	template <typename inputIteratorType> std::uint32_t readTrivigintetPC(inputIteratorType romStart, inputIteratorType romEnd, int offset)
+	template <typename inputIteratorType> Result<std::uint32_t> tryReadTrivigintetPC(inputIteratorType romStart, inputIteratorType romEnd, int offset) noexcept
+	{
+		if (offset < 0 || std::distance(romStart, romEnd) - 2 <= offset)
+			return ErrorCode::AddressOutOfBounds;
+		std::advance(romStart, offset);
+
+		std::uint8_t byte1 = *(romStart++);
+		std::uint8_t byte2 = *(romStart++);
+		std::uint8_t byte3 = *romStart;
+		return static_cast<std::uint32_t>((byte3 << 16) | (byte2 << 8) | byte1);
+	}
+
+	template <typename inputIteratorType> std::uint8_t readBytePC(inputIteratorType romStart, inputIteratorType romEnd, int offset)
+	{
+		return tryReadBytePC(romStart, romEnd, offset).value();
+	}
+
+	template <typename inputIteratorType> std::uint16_t readWordPC(inputIteratorType romStart, inputIteratorType romEnd, int offset)
 	{
-		auto byte1 = readBytePC(romStart, romEnd, offset + 0);
-		auto byte2 = readBytePC(romStart, romEnd, offset + 1);
-		auto byte3 = readBytePC(romStart, romEnd, offset + 2);
+		return tryReadWordPC(romStart, romEnd, offset).value();
+	}
 
-		return (byte3 << 16) | (byte2 << 8) | byte1;
+	template <typename inputIteratorType> std::uint32_t readTrivigintetPC(inputIteratorType romStart, inputIteratorType romEnd, int offset)
+	{
+		return tryReadTrivigintetPC(romStart, romEnd, offset).value();
 	}
 
 
+	template <typename inputIteratorType> Result<std::uint8_t> tryReadByteSFC(inputIteratorType romStart, inputIteratorType romEnd, int offset) noexcept
+	{
+		WORLDLIB_INSTRUMENT(ReadSFC);
+		auto address = trySFCToPC(romStart, romEnd, offset);
+		if (!address) return address.error();
+		WORLDLIB_COUNT(BytesReadSFC, 1);
+		return tryReadBytePC(romStart, romEnd, address.value());
+	}
+
 	template <typename inputIteratorType> std::uint8_t readByteSFC(inputIteratorType romStart, inputIteratorType romEnd, int offset)
 	{
-		return readBytePC(romStart, romEnd, SFCToPC(romStart, romEnd, offset));
+		WORLDLIB_INSTRUMENT(ReadSFC);
+		return tryReadByteSFC(romStart, romEnd, offset).value();
+	}
+
+	template <typename inputIteratorType> Result<std::uint16_t> tryReadWordSFC(inputIteratorType romStart, inputIteratorType romEnd, int offset) noexcept
+	{
+		WORLDLIB_INSTRUMENT(ReadSFC);
+		auto address = trySFCToPC(romStart, romEnd, offset);
+		if (!address) return address.error();
+		WORLDLIB_COUNT(BytesReadSFC, 2);
+		return tryReadWordPC(romStart, romEnd, address.value());
 	}
 
 	template <typename inputIteratorType> std::uint16_t readWordSFC(inputIteratorType romStart, inputIteratorType romEnd, int offset)
 	{
-		return readWordPC(romStart, romEnd, SFCToPC(romStart, romEnd, offset));
+		WORLDLIB_INSTRUMENT(ReadSFC);
+		return tryReadWordSFC(romStart, romEnd, offset).value();
+	}
+
+	template <typename inputIteratorType> Result<std::uint32_t> tryReadTrivigintetSFC(inputIteratorType romStart, inputIteratorType romEnd, int offset) noexcept
+	{
+		WORLDLIB_INSTRUMENT(ReadSFC);
+		auto address = trySFCToPC(romStart, romEnd, offset);
+		if (!address) return address.error();
+		WORLDLIB_COUNT(BytesReadSFC, 3);
+		return tryReadTrivigintetPC(romStart, romEnd, address.value());
 	}
 
 	template <typename inputIteratorType> std::uint32_t readTrivigintetSFC(inputIteratorType romStart, inputIteratorType romEnd, int offset)
 	{
-		return readTrivigintetPC(romStart, romEnd, SFCToPC(romStart, romEnd, offset));
+		WORLDLIB_INSTRUMENT(ReadSFC);
+		return tryReadTrivigintetSFC(romStart, romEnd, offset).value();
+	}
+
+	template <typename inputIteratorType, typename outputIteratorType> outputIteratorType readWordsSFC(inputIteratorType romStart, inputIteratorType romEnd, int offset, int count, outputIteratorType out)
+	{
+		if (count <= 0) return out;
+
+		WORLDLIB_INSTRUMENT(ReadSFC);
+		WORLDLIB_COUNT(BytesReadSFC, count * 2);
+
+		int start = SFCToPC(romStart, romEnd, offset);
+		int end = SFCToPC(romStart, romEnd, offset + count * 2 - 1);
+
+		if (end - start != count * 2 - 1)			// Crosses a bank boundary, so every word has to be converted on its own.
+		{
+			for (int i = 0; i < count; i++)
+				*(out++) = readWordPC(romStart, romEnd, SFCToPC(romStart, romEnd, offset + i * 2));
+			return out;
+		}
+
+		auto current = romStart;
+		std::advance(current, start);
+		auto last = current;
+		std::advance(last, count * 2 - 1);
+		if (last >= romEnd)
+			throw std::runtime_error("Address is out of bounds for the current ROM.");
+
+		for (int i = 0; i < count; i++)
+		{
+			std::uint8_t low = *(current++);
+			std::uint8_t high = *(current++);
+			*(out++) = static_cast<std::uint16_t>((high << 8) | low);
+		}
+
+		return out;
 	}
 
 	template <typename inputIteratorType, typename outputIteratorType> outputIteratorType getROMTitle(inputIteratorType romStart, inputIteratorType romEnd, outputIteratorType out, bool includeEndingSpaces)
@@ -0,0 +1,56 @@
+#pragma once
+#include "Instrumentation.hpp"
+#include <cstdint>
+
+// Define WORLDLIB_TRACING before including world-lib to record a timeline of the library's major entry points.  Without it every span compiles to nothing, and writeChromeTrace writes an empty trace.
+#ifndef WORLDLIB_TRACE_BUFFER_EVENTS
+#define WORLDLIB_TRACE_BUFFER_EVENTS 16384		// How many spans each thread keeps.  Older ones are overwritten.
+#endif
+
+#ifdef WORLDLIB_TRACING
+#define WORLDLIB_TRACE(name) ::worldlib::internal::TraceSpan worldlibTraceSpan(name, nullptr, 0)
+#define WORLDLIB_TRACE_ARG(name, argName, argValue) ::worldlib::internal::TraceSpan worldlibTraceSpan(name, argName, static_cast<std::int64_t>(argValue))
+#else
+#define WORLDLIB_TRACE(name) ((void)0)
+#define WORLDLIB_TRACE_ARG(name, argName, argValue) ((void)0)
+#endif
+
+namespace worldlib
+{
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file Tracing.hpp
+/// \brief Contains optional timeline tracing that can be saved in the Chrome trace format.
+///
+/// \addtogroup Internal
+///  @{
+//////////////////////////////////////////////////////////////////////////////
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief Returns true if the library was compiled with WORLDLIB_TRACING
+	////////////////////////////////////////////////////////////
+	inline bool isTracingEnabled();
+
+	////////////////////////////////////////////////////////////
+	/// \brief Writes every thread's recorded spans as Chrome trace JSON, which chrome://tracing and Perfetto can open.
+	/// \details Spans are recorded for getLevelPalette, decompressGraphicsFile, indexedImageToBitmap (the whole-image versions; single tiles aren't recorded) and patchToROM, with the level or file number as an argument where there is one.
+	/// Each thread keeps its last WORLDLIB_TRACE_BUFFER_EVENTS spans in its own ring buffer, so recording never waits on a lock.
+	/// This can be called while other threads are still recording.  Spans that are overwritten while they're being copied are left out.
+	/// Spans are written when they end, so ones that are still running aren't included.
+	///
+	/// \param out			Where to write the JSON, one char at a time
+	///
+	/// \return The output iterator after writing
+	///
+	////////////////////////////////////////////////////////////
+	template <typename outputIteratorType>
+	outputIteratorType writeChromeTrace(outputIteratorType out);
+
+
+//////////////////////////////////////////////////////////////////////////////
+///  @}
+//////////////////////////////////////////////////////////////////////////////
+}
+
+#include "Tracing.inl"
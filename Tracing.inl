@@ -0,0 +1,241 @@
+#include "Internal.hpp"
+#include <string>
+#include <algorithm>
+
+#ifdef WORLDLIB_TRACING
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <chrono>
+#endif
+
+namespace worldlib
+{
+	namespace internal
+	{
+#ifdef WORLDLIB_TRACING
+		// One finished span.  Every field is atomic so writeChromeTrace can copy it while the owning thread might be overwriting it; torn copies are thrown away afterwards.
+		struct TraceEvent
+		{
+			std::atomic<const char *> name;
+			std::atomic<const char *> argName;
+			std::atomic<std::int64_t> argValue;
+			std::atomic<std::uint64_t> start;		// Nanoseconds, from steady_clock's epoch
+			std::atomic<std::uint64_t> duration;
+		};
+
+		// The plain copy of a TraceEvent that writeChromeTrace works with
+		struct TraceEventCopy
+		{
+			const char *name;
+			const char *argName;
+			std::int64_t argValue;
+			std::uint64_t start;
+			std::uint64_t duration;
+			int threadID;
+		};
+
+		// One thread's ring buffer.  Only the owning thread writes to it, and it only publishes a span (by bumping written) once the span is fully stored.
+		struct ThreadTrace
+		{
+			int threadID;
+			std::atomic<bool> inUse;			// False once the owning thread has finished, so a new thread can take the buffer over
+			std::atomic<std::uint64_t> written;		// How many spans have ever been stored.  The newest is at (written - 1) % WORLDLIB_TRACE_BUFFER_EVENTS.
+			TraceEvent events[WORLDLIB_TRACE_BUFFER_EVENTS];
+		};
+
+		struct TraceRegistry
+		{
+			std::mutex lock;
+			std::vector<ThreadTrace *> threads;
+		};
+
+		inline std::uint64_t traceTimestamp()
+		{
+			return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+		}
+
+		inline TraceRegistry &getTraceRegistry()
+		{
+			static TraceRegistry registry;
+			return registry;
+		}
+
+#if !defined(_MSC_VER) || _MSC_VER >= 1900
+		// Gives the thread's buffer back when the thread finishes.  VS2013's __declspec(thread) can't run destructors, so there buffers are never reused.
+		struct ThreadTraceRelease
+		{
+			ThreadTrace *trace;
+			~ThreadTraceRelease() { if (trace != nullptr) trace->inUse.store(false, std::memory_order_release); }
+		};
+#endif
+
+		// Buffers are never freed, so the spans of finished threads can still be written.  A new thread reuses a finished thread's buffer (and its tid in the trace) before making a new one,
+		// which keeps memory bounded when threads are started over and over, like indexedImageToBitmapParallel's helpers.
+		inline ThreadTrace &getThreadTrace()
+		{
+			static WORLDLIB_THREAD_LOCAL ThreadTrace *trace = nullptr;
+			if (trace == nullptr)
+			{
+				auto &registry = getTraceRegistry();
+				std::lock_guard<std::mutex> lock(registry.lock);
+				for (auto unused : registry.threads)
+				{
+					if (unused->inUse.load(std::memory_order_acquire) == false)
+					{
+						trace = unused;
+						break;
+					}
+				}
+				if (trace == nullptr)
+				{
+					trace = new ThreadTrace;
+					trace->written.store(0);
+					trace->threadID = (int)registry.threads.size() + 1;
+					registry.threads.push_back(trace);
+				}
+				trace->inUse.store(true, std::memory_order_relaxed);
+#if !defined(_MSC_VER) || _MSC_VER >= 1900
+				static thread_local ThreadTraceRelease release = { nullptr };
+				release.trace = trace;
+#endif
+			}
+			return *trace;
+		}
+
+		// Records a span from when it's constructed to when it's destroyed
+		class TraceSpan
+		{
+		public:
+			TraceSpan(const char *name, const char *argName, std::int64_t argValue) : name(name), argName(argName), argValue(argValue), start(traceTimestamp()) {}
+
+			~TraceSpan()
+			{
+				auto end = traceTimestamp();
+				auto &trace = getThreadTrace();
+				auto index = trace.written.load(std::memory_order_relaxed);
+				auto &event = trace.events[index % WORLDLIB_TRACE_BUFFER_EVENTS];
+
+				// written == index already marks the span this slot held as overwritten.  This fence pairs with the acquire fence in copyThreadTrace:  it keeps the stores
+				// below from being seen before the store that made written index, so a reader that copies any of them is sure to see that written moved on and drop the copy.
+				std::atomic_thread_fence(std::memory_order_release);
+				event.name.store(name, std::memory_order_relaxed);
+				event.argName.store(argName, std::memory_order_relaxed);
+				event.argValue.store(argValue, std::memory_order_relaxed);
+				event.start.store(start, std::memory_order_relaxed);
+				event.duration.store(end - start, std::memory_order_relaxed);
+				trace.written.store(index + 1, std::memory_order_release);
+			}
+
+		private:
+			TraceSpan(const TraceSpan &);
+			TraceSpan &operator=(const TraceSpan &);
+
+			const char *name;
+			const char *argName;
+			std::int64_t argValue;
+			std::uint64_t start;
+		};
+
+		// Copies whichever of a thread's spans are still intact into events
+		inline void copyThreadTrace(const ThreadTrace &trace, std::vector<TraceEventCopy> &events)
+		{
+			const std::uint64_t capacity = WORLDLIB_TRACE_BUFFER_EVENTS;
+			auto end = trace.written.load(std::memory_order_acquire);
+			auto begin = end > capacity ? end - capacity : 0;
+
+			std::vector<TraceEventCopy> copied;
+			copied.reserve(static_cast<std::size_t>(end - begin));
+			for (auto i = begin; i < end; i++)
+			{
+				auto &event = trace.events[i % capacity];
+				TraceEventCopy copy = { event.name.load(std::memory_order_relaxed), event.argName.load(std::memory_order_relaxed), event.argValue.load(std::memory_order_relaxed),
+							event.start.load(std::memory_order_relaxed), event.duration.load(std::memory_order_relaxed), trace.threadID };
+				copied.push_back(copy);
+			}
+
+			// Anything the owning thread could have started overwriting while we were copying is unreliable.  Pairs with the release fence in ~TraceSpan.
+			std::atomic_thread_fence(std::memory_order_acquire);
+			auto after = trace.written.load(std::memory_order_relaxed);
+			auto firstIntact = after + 1 > capacity ? after + 1 - capacity : 0;
+			for (auto i = begin; i < end; i++)
+				if (i >= firstIntact) events.push_back(copied[static_cast<std::size_t>(i - begin)]);
+		}
+#endif
+
+		template <typename outputIteratorType>
+		outputIteratorType writeTraceText(outputIteratorType out, const std::string &text)
+		{
+			for (auto c : text) *(out++) = c;
+			return out;
+		}
+
+		// Writes a JSON string.  Span names are string literals from the library, but they're escaped anyway.
+		template <typename outputIteratorType>
+		outputIteratorType writeTraceString(outputIteratorType out, const char *text)
+		{
+			*(out++) = '"';
+			for (; *text != 0; text++)
+			{
+				if (*text == '"' || *text == '\\') *(out++) = '\\';
+				*(out++) = *text;
+			}
+			*(out++) = '"';
+			return out;
+		}
+
+		// Chrome traces are in microseconds, so nanoseconds are written with 3 decimal places
+		inline std::string traceMicroseconds(std::uint64_t nanoseconds)
+		{
+			auto fraction = std::to_string(nanoseconds % 1000);
+			return std::to_string(nanoseconds / 1000) + "." + std::string(3 - fraction.size(), '0') + fraction;
+		}
+	}
+
+	inline bool isTracingEnabled()
+	{
+#ifdef WORLDLIB_TRACING
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	template <typename outputIteratorType>
+	outputIteratorType writeChromeTrace(outputIteratorType out)
+	{
+		out = internal::writeTraceText(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+#ifdef WORLDLIB_TRACING
+		std::vector<internal::TraceEventCopy> events;
+		{
+			auto &registry = internal::getTraceRegistry();
+			std::lock_guard<std::mutex> lock(registry.lock);
+			for (auto thread : registry.threads)
+				internal::copyThreadTrace(*thread, events);
+		}
+
+		std::uint64_t start = events.empty() ? 0 : events.front().start;		// Timestamps are written relative to the earliest span
+		for (auto &event : events) start = std::min(start, event.start);
+
+		bool first = true;
+		for (auto &event : events)
+		{
+			out = internal::writeTraceText(out, first ? "\n{\"name\":" : ",\n{\"name\":");
+			first = false;
+			out = internal::writeTraceString(out, event.name);
+			out = internal::writeTraceText(out, ",\"cat\":\"worldlib\",\"ph\":\"X\",\"pid\":1,\"tid\":" + std::to_string(event.threadID));
+			out = internal::writeTraceText(out, ",\"ts\":" + internal::traceMicroseconds(event.start - start) + ",\"dur\":" + internal::traceMicroseconds(event.duration));
+			if (event.argName != nullptr)
+			{
+				out = internal::writeTraceText(out, ",\"args\":{");
+				out = internal::writeTraceString(out, event.argName);
+				out = internal::writeTraceText(out, ":" + std::to_string(event.argValue) + "}");
+			}
+			*(out++) = '}';
+		}
+#endif
+
+		return internal::writeTraceText(out, "\n]}\n");
+	}
+}
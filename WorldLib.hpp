@@ -44,8 +44,21 @@
 
 
 #include "Level.hpp"
+#include "LevelIndex.hpp"
+#include "GraphicsDirectory.hpp"
+#include "GraphicsUsageIndex.hpp"
+#include "LevelObjects.hpp"
+#include "LevelSprites.hpp"
+#include "Map16.hpp"
+#include "LevelRenderer.hpp"
+#include "AnimatedTiles.hpp"
+#include "PNG.hpp"
+#include "Compositor.hpp"
 #include "LunarMagic.hpp"
 #include "SFC.hpp"
+#include "Result.hpp"
+#include "Instrumentation.hpp"
+#include "Tracing.hpp"
 
 #ifndef __cplusplus_cli		// Something strange about Asar's functions being defined multiple times when compiled under CLI even though Patch.hpp only *declares* stuff.  I don't even know.
 #include "Patch.hpp"
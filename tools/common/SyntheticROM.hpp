@@ -0,0 +1,123 @@
+#pragma once
+#include <vector>
+#include <random>
+#include <cstdint>
+
+namespace worldlib
+{
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file SyntheticROM.hpp
+/// \brief Contains functions for building fake Lunar Magic-edited ROMs to run the tools against, since real ones can't be shipped.
+///
+/// \addtogroup Internal
+///  @{
+//////////////////////////////////////////////////////////////////////////////
+
+
+	////////////////////////////////////////////////////////////
+	/// \brief What to put in a ROM made by makeSyntheticROM.  The defaults make a 2MB LoROM with every level and 0x100 ExGFX files.
+	////////////////////////////////////////////////////////////
+	struct SyntheticROMOptions
+	{
+		////////////////////////////////////////////////////////////
+		/// \brief Size of the ROM in bytes.  Must be a multiple of 0x8000 from 1MB to 4MB.
+		////////////////////////////////////////////////////////////
+		int size;
+
+		////////////////////////////////////////////////////////////
+		/// \brief If true, the header says the ROM is SA-1, and data past 2MB is pointed to through banks 80-BF
+		////////////////////////////////////////////////////////////
+		bool sa1;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The compression format byte to store in the ROM (1 for LZ2, 2 for LZ3).  Every graphics file is compressed with it.
+		////////////////////////////////////////////////////////////
+		int compressionType;
+
+		////////////////////////////////////////////////////////////
+		/// \brief How many levels get their own data, starting from level 0.  The rest all share one empty single-screen level, like an unedited ROM's unused levels.
+		////////////////////////////////////////////////////////////
+		int levelCount;
+
+		////////////////////////////////////////////////////////////
+		/// \brief How many screens each level is (1 - 32)
+		////////////////////////////////////////////////////////////
+		int screensPerLevel;
+
+		////////////////////////////////////////////////////////////
+		/// \brief How many layer 1 objects each screen has
+		////////////////////////////////////////////////////////////
+		int objectsPerScreen;
+
+		////////////////////////////////////////////////////////////
+		/// \brief How many sprites each screen has
+		////////////////////////////////////////////////////////////
+		int spritesPerScreen;
+
+		////////////////////////////////////////////////////////////
+		/// \brief How many ExGFX files to insert, numbered from 80 up (and on into the 100+ range past FF)
+		////////////////////////////////////////////////////////////
+		int exgfxCount;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Decompressed size of each ExGFX file.  GFX00-31 are always 3bpp (0xC00 bytes), like the original game's.
+		////////////////////////////////////////////////////////////
+		int exgfxSize;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Out of 100, how many levels have a custom palette
+		////////////////////////////////////////////////////////////
+		int customPalettePercent;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Out of 100, how many levels use ExGFX instead of their tilesets' graphics.  Needs exgfxCount to be at least 1.
+		////////////////////////////////////////////////////////////
+		int exgfxLevelPercent;
+
+		////////////////////////////////////////////////////////////
+		/// \brief The seed for everything random in the ROM.  The same options always make the same ROM.
+		////////////////////////////////////////////////////////////
+		std::uint32_t seed;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Sets every option to its default
+		////////////////////////////////////////////////////////////
+		SyntheticROMOptions();
+	};
+
+	////////////////////////////////////////////////////////////
+	/// \brief Builds a ROM that passes checkROMValid and has everything the library reads in the places Lunar Magic puts it.
+	/// \details The ROM has the SMW title and Lunar Magic's string, the vanilla palette and graphics tables, GFX00-31, the ExGFX pointer tables and ExGFX bypass list, and level, sprite and custom palette data for every level.
+	/// Graphics files are real compressed data (see makeSyntheticCompressedData), so decompressing them costs about what it would in a real ROM, but the tiles are just noise.
+	/// Nothing in it is copied from the original game.  The result has no copier header.
+	///
+	/// \param options		What to put in the ROM
+	///
+	/// \return The ROM's bytes
+	///
+	/// \throws std::runtime_error If an option is out of range, or everything asked for won't fit in the ROM
+	///
+	////////////////////////////////////////////////////////////
+	std::vector<std::uint8_t> makeSyntheticROM(const SyntheticROMOptions &options);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Builds a valid LZ2 or LZ3 stream that decompresses to exactly size bytes, using every command the format has.
+	/// \details The mix is weighted towards what real graphics files contain:  lots of short literal runs and back-references, and some fills.
+	///
+	/// \param random		Where the data and the choice of commands come from
+	/// \param size			How many bytes the stream should decompress to (at least 1)
+	/// \param lz3			True for LZ3, false for LZ2
+	///
+	/// \return The compressed stream, including its end marker
+	///
+	////////////////////////////////////////////////////////////
+	std::vector<std::uint8_t> makeSyntheticCompressedData(std::mt19937 &random, int size, bool lz3);
+
+
+//////////////////////////////////////////////////////////////////////////////
+///  @}
+//////////////////////////////////////////////////////////////////////////////
+}
+
+#include "SyntheticROM.inl"
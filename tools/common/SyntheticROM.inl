@@ -0,0 +1,361 @@
+#include "../../Internal.hpp"
+#include <stdexcept>
+#include <string>
+#include <algorithm>
+
+namespace worldlib
+{
+	inline SyntheticROMOptions::SyntheticROMOptions() : size(0x200000), sa1(false), compressionType(2), levelCount(internal::levelCount), screensPerLevel(8), objectsPerScreen(6), spritesPerScreen(3), exgfxCount(0x100), exgfxSize(0x1000), customPalettePercent(50), exgfxLevelPercent(75), seed(0x534D57)
+	{
+	}
+
+	namespace internal
+	{
+		const int syntheticFreeSpaceStart = 0x80000;			// PC offset of the first byte after bank 0F, where the last fixed table is
+		const int syntheticLevelHeaderSize = 5;
+		const int syntheticCustomPaletteSize = 0x202;			// The background color, then 256 colors
+		const int syntheticSuperExGFXTableSize = exgfxBypassOffset + levelCount * exgfxBypassEntrySize;
+
+		// Writes a compression command header, using the long form when the run doesn't fit in 5 bits.
+		inline void writeSyntheticCommand(std::vector<std::uint8_t> &out, int command, int length)
+		{
+			if (length <= 32)
+			{
+				out.push_back(static_cast<std::uint8_t>((command << 5) | (length - 1)));
+			}
+			else
+			{
+				out.push_back(static_cast<std::uint8_t>(0xE0 | (command << 2) | ((length - 1) >> 8)));
+				out.push_back(static_cast<std::uint8_t>(length - 1));
+			}
+		}
+
+		// Writes into a ROM that's being built, and hands out its free space in order.
+		class SyntheticROMWriter
+		{
+		public:
+			SyntheticROMWriter(std::vector<std::uint8_t> &rom, bool sa1) : rom(rom), sa1(sa1), freeSpace(syntheticFreeSpaceStart)
+			{
+			}
+
+			// The inverse of SFCToPC.  Past 2MB, LoROM ROMs use the C0+ mirrors (so banks 7E and 7F aren't WRAM), and SA-1 ROMs use banks 80-BF.
+			int toSFC(int pc) const
+			{
+				int address = ((pc << 1) & 0x7F0000) | (pc & 0x7FFF) | 0x8000;
+				if (address >= 0x400000) address += sa1 ? 0x400000 : 0x800000;
+				return address;
+			}
+
+			// Only used for the fixed tables, which are all in the first 1MB.
+			int toPC(int sfc) const
+			{
+				return ((sfc & 0x7F0000) >> 1) | (sfc & 0x7FFF);
+			}
+
+			void writeByte(int sfc, int value)
+			{
+				rom[toPC(sfc)] = static_cast<std::uint8_t>(value);
+			}
+
+			void writeWord(int sfc, int value)
+			{
+				writeByte(sfc + 0, value);
+				writeByte(sfc + 1, value >> 8);
+			}
+
+			void writeTrivigintet(int sfc, int value)
+			{
+				writeByte(sfc + 0, value);
+				writeByte(sfc + 1, value >> 8);
+				writeByte(sfc + 2, value >> 16);
+			}
+
+			void writeString(int sfc, const std::string &text)
+			{
+				for (std::size_t i = 0; i < text.size(); i++)
+					writeByte(sfc + (int)i, text[i]);
+			}
+
+			// Copies data into the next free space and returns its SFC address.
+			// Like Lunar Magic, nothing is split across a bank boundary unless it's bigger than a bank, since the library reads tables through SFC addresses one at a time.
+			int allocate(const std::vector<std::uint8_t> &data)
+			{
+				if (freeSpace % 0x8000 + (int)data.size() > 0x8000)
+					freeSpace = (freeSpace + 0x7FFF) & ~0x7FFF;
+				if (freeSpace + (int)data.size() > (int)rom.size())
+					throw std::runtime_error("The synthetic ROM is too small for everything that was asked for.");
+
+				std::copy(data.begin(), data.end(), rom.begin() + freeSpace);
+				int address = toSFC(freeSpace);
+				freeSpace += (int)data.size();
+				return address;
+			}
+
+		private:
+			std::vector<std::uint8_t> &rom;
+			bool sa1;
+			int freeSpace;
+		};
+
+		inline std::vector<std::uint8_t> makeSyntheticColors(std::mt19937 &random, int count)
+		{
+			std::vector<std::uint8_t> colors;
+			for (int i = 0; i < count; i++)
+			{
+				std::uint16_t color = random() & 0x7FFF;
+				colors.push_back(static_cast<std::uint8_t>(color));
+				colors.push_back(static_cast<std::uint8_t>(color >> 8));
+			}
+			return colors;
+		}
+
+		// A level's header and layer 1 objects:  a screen exit, then objectsPerScreen standard and extended objects on each screen.
+		inline std::vector<std::uint8_t> makeSyntheticLevelData(std::mt19937 &random, int screens, int objectsPerScreen)
+		{
+			std::vector<std::uint8_t> data;
+			data.push_back(static_cast<std::uint8_t>(((random() % 8) << 5) | (screens - 1)));	// BG palette, screen count
+			data.push_back(static_cast<std::uint8_t>(((random() % 8) << 5) | (random() & 0x1F)));	// BG color, level mode
+			data.push_back(static_cast<std::uint8_t>((random() & 0xF0) | (random() % 0x10)));	// Sprite tileset
+			data.push_back(static_cast<std::uint8_t>(random()));					// FG and sprite palettes
+			data.push_back(static_cast<std::uint8_t>((random() & 0xF0) | (random() % 0x0E)));	// FG/BG tileset
+
+			// 000SSSSS 0000wush 00000000 DDDDDDDD
+			data.push_back(static_cast<std::uint8_t>(random() % screens));
+			data.push_back(static_cast<std::uint8_t>(random() & 0x01));
+			data.push_back(0x00);
+			data.push_back(static_cast<std::uint8_t>(random()));
+
+			for (int screen = 0; screen < screens; screen++)
+			{
+				for (int i = 0; i < objectsPerScreen; i++)
+				{
+					// NBBYYYYY bbbbXXXX SSSSSSSS
+					std::uint8_t newScreen = (i == 0 && screen > 0) ? 0x80 : 0x00;
+					int y = random() % 0x1B, x = random() % 0x10;
+
+					if (random() % 16 == 0)
+					{
+						data.push_back(newScreen | static_cast<std::uint8_t>(y));
+						data.push_back(static_cast<std::uint8_t>(x));
+						data.push_back(static_cast<std::uint8_t>(0x02 + random() % 0xFE));	// 00 and 01 are screen exits and jumps
+						continue;
+					}
+
+					int number = 1 + random() % 0x3F;
+					data.push_back(newScreen | static_cast<std::uint8_t>(((number & 0x30) << 1) | y));
+					data.push_back(static_cast<std::uint8_t>(((number & 0x0F) << 4) | x));
+					data.push_back(static_cast<std::uint8_t>(random()));
+					if (number == 0x22 || number == 0x23) data.push_back(static_cast<std::uint8_t>(random()));
+					if (number == 0x23) data.push_back(static_cast<std::uint8_t>(random()));
+				}
+			}
+
+			data.push_back(0xFF);
+			return data;
+		}
+
+		// A level's sprite header and sprites, spritesPerScreen on each screen.
+		inline std::vector<std::uint8_t> makeSyntheticSpriteData(std::mt19937 &random, int screens, int spritesPerScreen)
+		{
+			std::vector<std::uint8_t> data;
+			data.push_back(static_cast<std::uint8_t>(random() & 0x3F));
+
+			for (int screen = 0; screen < screens; screen++)
+			{
+				for (int i = 0; i < spritesPerScreen; i++)
+				{
+					// yyyyEESY XXXXssss NNNNNNNN.  y stays under 1F so the first byte can never be the end marker.
+					int y = random() % 0x1C, x = random() % 0x10;
+					data.push_back(static_cast<std::uint8_t>(((y & 0x0F) << 4) | ((screen & 0x10) >> 3) | (y >> 4)));
+					data.push_back(static_cast<std::uint8_t>((x << 4) | (screen & 0x0F)));
+					data.push_back(static_cast<std::uint8_t>(random()));
+				}
+			}
+
+			data.push_back(0xFF);
+			return data;
+		}
+	}
+
+	inline std::vector<std::uint8_t> makeSyntheticCompressedData(std::mt19937 &random, int size, bool lz3)
+	{
+		std::vector<std::uint8_t> out;
+		int written = 0;
+		while (written < size)
+		{
+			int length = std::min(size - written, 1 + (int)(random() % ((random() % 4 == 0) ? 256 : 32)));
+			int command = random() % 8;
+
+			if (command < 3 || written < 32)					// Direct copy
+			{
+				internal::writeSyntheticCommand(out, 0, length);
+				for (int i = 0; i < length; i++) out.push_back(static_cast<std::uint8_t>(random()));
+			}
+			else if (command == 3)							// Byte fill
+			{
+				internal::writeSyntheticCommand(out, 1, length);
+				out.push_back(static_cast<std::uint8_t>(random()));
+			}
+			else if (command == 4)							// Word fill
+			{
+				internal::writeSyntheticCommand(out, 2, length);
+				out.push_back(static_cast<std::uint8_t>(random()));
+				out.push_back(static_cast<std::uint8_t>(random()));
+			}
+			else if (command == 5)							// Increasing fill (LZ2), zero fill (LZ3)
+			{
+				internal::writeSyntheticCommand(out, 3, length);
+				if (!lz3) out.push_back(static_cast<std::uint8_t>(random()));
+			}
+			else									// Repeats
+			{
+				length = std::min(length, written);
+				if (!lz3)
+				{
+					int offset = random() % (written - length + 1);
+					internal::writeSyntheticCommand(out, 4, length);
+					out.push_back(static_cast<std::uint8_t>(offset >> 8));
+					out.push_back(static_cast<std::uint8_t>(offset));
+				}
+				else
+				{
+					// Absolute offsets are only 15 bits in LZ3, so streams over 32KB can only reach back into their first 32KB with them.
+					int type = 4 + random() % 3;					// Repeat, bit-reversed repeat, backwards repeat
+					int lastStart = std::min(written - 1, 0x7FFF) - (length - 1);
+					int offset = (type == 6) ? length - 1 + random() % (lastStart + 1) : random() % (lastStart + 1);
+					internal::writeSyntheticCommand(out, type, length);
+					if (type != 6 && written - offset <= 0x80 && random() % 2 == 0)
+					{
+						out.push_back(static_cast<std::uint8_t>(0x80 | (written - offset - 1)));
+					}
+					else
+					{
+						out.push_back(static_cast<std::uint8_t>(offset >> 8));
+						out.push_back(static_cast<std::uint8_t>(offset));
+					}
+				}
+			}
+			written += length;
+		}
+		out.push_back(0xFF);
+		return out;
+	}
+
+	inline std::vector<std::uint8_t> makeSyntheticROM(const SyntheticROMOptions &options)
+	{
+		if (options.size < 0x100000 || options.size > 0x400000 || options.size % 0x8000 != 0)
+			throw std::runtime_error("Synthetic ROMs must be a multiple of 0x8000 bytes from 1MB to 4MB.");
+		if (options.compressionType != 1 && options.compressionType != 2)
+			throw std::runtime_error("The compression type must be 1 (LZ2) or 2 (LZ3).");
+		if (options.levelCount < 0 || options.levelCount > internal::levelCount)
+			throw std::runtime_error("Level count is out of range.");
+		if (options.screensPerLevel < 1 || options.screensPerLevel > 0x20)
+			throw std::runtime_error("Levels must have 1 - 32 screens.");
+		if (options.objectsPerScreen < 0 || options.spritesPerScreen < 0)
+			throw std::runtime_error("Object and sprite counts can't be negative.");
+		if (options.exgfxCount < 0 || options.exgfxCount > 0x1000 - 0x80)
+			throw std::runtime_error("ExGFX count is out of range.");
+		if (options.exgfxSize < 1 || options.exgfxSize > 0x10000)
+			throw std::runtime_error("ExGFX files must be 1 - 0x10000 bytes.");
+		if (options.customPalettePercent < 0 || options.customPalettePercent > 100 || options.exgfxLevelPercent < 0 || options.exgfxLevelPercent > 100)
+			throw std::runtime_error("Percentages must be 0 - 100.");
+
+		std::mt19937 random(options.seed);
+		bool lz3 = options.compressionType == 2;
+		std::vector<std::uint8_t> rom(options.size, 0x00);
+		internal::SyntheticROMWriter writer(rom, options.sa1);
+
+		// Internal header.  Sizes that aren't a power of 2 round up, like they do on real cartridges.
+		int sizeExponent = 0;
+		while ((0x400 << sizeExponent) < options.size) sizeExponent++;
+		writer.writeString(0x00FFC0, "SUPER MARIOWORLD     ");
+		writer.writeByte(0x00FFD5, options.sa1 ? 0x23 : 0x20);
+		writer.writeByte(0x00FFD6, options.sa1 ? 0x35 : 0x02);
+		writer.writeByte(0x00FFD7, sizeExponent);
+		writer.writeByte(0x00FFD8, 0x01);
+		writer.writeByte(0x00FFD9, 0x01);
+		writer.writeWord(0x00FFDC, 0xFFFF);
+		writer.writeWord(0x00FFDE, 0x0000);
+
+		writer.writeString(0x0FF0A0, "Lunar Magic Version 3.40 Public");
+		writer.writeByte(internal::decompressionTypeLocation, options.compressionType);
+
+		// Vanilla palettes and tileset graphics lists.
+		auto sharedPalettes = internal::makeSyntheticColors(random, (0x00B700 - internal::sharedBackgroundColorsLocation) / 2);
+		for (std::size_t i = 0; i < sharedPalettes.size(); i++)
+			writer.writeByte(internal::sharedBackgroundColorsLocation + (int)i, sharedPalettes[i]);
+		for (int i = 0; i < 26 * 4; i++)
+		{
+			writer.writeByte(internal::spriteSlotListTableLocation + i, random() % 0x32);
+			writer.writeByte(internal::backgroundSlotListTableLocation + i, random() % 0x32);
+		}
+
+		// GFX00-31
+		for (int file = 0; file <= 0x31; file++)
+		{
+			int address = writer.allocate(makeSyntheticCompressedData(random, 0xC00, lz3));
+			writer.writeByte(internal::originalGraphicsFilesLowByteTableLocation + file, address);
+			writer.writeByte(internal::originalGraphicsFilesHighByteTableLocation + file, address >> 8);
+			writer.writeByte(internal::originalGraphicsFilesBankByteTableLocation + file, address >> 16);
+		}
+
+		// ExGFX80-FF have a table of their own, and ExGFX100-FFF share theirs with the ExGFX bypass list.  Unused entries are FFFFFF.
+		int standardTable = writer.allocate(std::vector<std::uint8_t>(0x80 * 3, 0xFF));
+		int superTable = writer.allocate(std::vector<std::uint8_t>(internal::syntheticSuperExGFXTableSize, 0xFF));
+		writer.writeTrivigintet(internal::standardExGFXPointerToPointerTableLocation, standardTable);
+		writer.writeTrivigintet(internal::superExGFXPointerToPointerTableLocation, superTable);
+
+		for (int i = 0; i < options.exgfxCount; i++)
+		{
+			int file = 0x80 + i;
+			int address = writer.allocate(makeSyntheticCompressedData(random, options.exgfxSize, lz3));
+			if (file <= 0xFF)
+				writer.writeTrivigintet(standardTable + (file - 0x80) * 3, address);
+			else
+				writer.writeTrivigintet(superTable + (file - 0x100) * 3, address);
+		}
+
+		// Levels past levelCount all share one empty level, like the unused levels in an unedited ROM.
+		int emptyLevel = writer.allocate(internal::makeSyntheticLevelData(random, 1, 0));
+		int emptySprites = writer.allocate(internal::makeSyntheticSpriteData(random, 1, 0));
+		int layer2 = writer.allocate(internal::makeSyntheticLevelData(random, 1, 4));
+
+		for (int level = 0; level < internal::levelCount; level++)
+		{
+			bool used = level < options.levelCount;
+			int layer1 = used ? writer.allocate(internal::makeSyntheticLevelData(random, options.screensPerLevel, options.objectsPerScreen)) : emptyLevel;
+			int sprites = used ? writer.allocate(internal::makeSyntheticSpriteData(random, options.screensPerLevel, options.spritesPerScreen)) : emptySprites;
+			int palette = (used && (int)(random() % 100) < options.customPalettePercent) ? writer.allocate(internal::makeSyntheticColors(random, internal::syntheticCustomPaletteSize / 2)) : 0;
+
+			writer.writeTrivigintet(internal::layer1PointerTableLocation + level * 3, layer1);
+			writer.writeTrivigintet(internal::layer2PointerTableLocation + level * 3, layer2);
+			writer.writeWord(internal::spritePointerTableLocation + level * 2, sprites);
+			writer.writeByte(internal::spriteDataBankTableLocation + level, sprites >> 16);
+			writer.writeTrivigintet(internal::customPalettePointerTableLocation + level * 3, palette);
+
+			// Byte 1's top bit is the ExGFX flag, and the slots are words from 0x06 (BG3) to 0x1A (AN2).  Levels without it keep 0s.
+			int entry = superTable + internal::exgfxBypassOffset + level * internal::exgfxBypassEntrySize;
+			for (int i = 0; i < internal::exgfxBypassEntrySize; i++)
+				writer.writeByte(entry + i, 0x00);
+
+			if (used && options.exgfxCount > 0 && (int)(random() % 100) < options.exgfxLevelPercent)
+			{
+				writer.writeWord(entry, 0x8000);
+				for (int offset = 0x06; offset <= 0x1A; offset += 2)
+				{
+					int file = (random() % 4 == 0) ? random() % 0x32 : 0x80 + random() % options.exgfxCount;
+					if ((offset == 0x06 || offset == 0x1A) && random() % 2 == 0) file = 0x7F;
+					writer.writeWord(entry + offset, file);
+				}
+			}
+		}
+
+		// The checksum and its complement always add up to FFFF, so the bytes already there count the same as the real ones will.
+		std::uint16_t checksum = 0;
+		for (auto byte : rom) checksum += byte;
+		writer.writeWord(0x00FFDC, checksum ^ 0xFFFF);
+		writer.writeWord(0x00FFDE, checksum);
+
+		return rom;
+	}
+}
@@ -0,0 +1,491 @@
+// worldlib-bench:  microbenchmarks for the library's hot functions.
+//
+// Usage:  worldlib-bench [--filter text] [--samples N] [--warmup-ms N] [--sample-ms N] [--json file] [--list]
+//
+// Every benchmark is warmed up, then timed as a number of samples that each run long enough to be measured reliably.
+// A summary table goes to stderr and the full results go to stdout (or the --json file) as JSON, so two versions of the library can be compared by diffing or loading the files.
+// All of the input data is generated from fixed seeds, so every run measures exactly the same work.  Nothing is read from disk:  the rom/ benchmarks run on ROMs from makeSyntheticROM.
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <random>
+#include <chrono>
+
+#define WORLDLIB_IGNORE_DLL_FUNCTIONS
+#include "../../SFC.hpp"
+#include "../../WorldLib.hpp"
+#include "../common/SyntheticROM.hpp"
+
+using namespace worldlib;
+
+namespace
+{
+	struct Benchmark
+	{
+		std::string name;
+		std::string unit;				// What one iteration processes:  "bytes" or "items"
+		double workPerIteration;			// How many units one iteration processes
+		std::function<void()> run;
+	};
+
+	struct BenchmarkResult
+	{
+		const Benchmark *benchmark;
+		long long iterationsPerSample;
+		std::vector<double> samples;			// Nanoseconds per iteration
+		double min, max, mean, median, stddev;
+	};
+
+	// Results are added in here so the compiler can't throw the work away.
+	volatile std::uint64_t sink;
+
+	void consume(std::uint64_t value)
+	{
+		sink = sink + value;
+	}
+
+
+	////////////////////////////////////////////////////////////
+	// Input data
+	////////////////////////////////////////////////////////////
+
+	std::vector<std::uint8_t> makeRandomBytes(std::mt19937 &random, int size)
+	{
+		std::vector<std::uint8_t> data(size);
+		for (auto &byte : data) byte = static_cast<std::uint8_t>(random());
+		return data;
+	}
+
+	std::vector<std::uint32_t> makeRandomColors(std::mt19937 &random, int count)
+	{
+		std::vector<std::uint32_t> colors(count);
+		for (auto &color : colors) color = 0xFF000000 | (random() & 0xF8F8F8);
+		return colors;
+	}
+
+	// Addresses all over a 1MB ROM's banks.  When sa1 is true, half of them are in banks C0-DF instead, which SFCToPC has to remap.
+	std::vector<int> makeAddresses(std::mt19937 &random, int count, bool sa1)
+	{
+		std::vector<int> addresses(count);
+		for (auto &address : addresses)
+		{
+			address = ((random() % 0x20) << 16) | 0x8000 | (random() & 0x7FFE);
+			if (sa1 && random() % 2 == 0) address += 0xC00000;
+		}
+		return addresses;
+	}
+
+
+	////////////////////////////////////////////////////////////
+	// The benchmarks
+	////////////////////////////////////////////////////////////
+
+	std::vector<Benchmark> makeBenchmarks()
+	{
+		std::vector<Benchmark> benchmarks;
+		std::mt19937 random(0x5EED);
+
+		// Decompression:  a regular 4bpp graphics file, and a large ExGFX file.
+		for (int lz3 = 0; lz3 < 2; lz3++)
+		{
+			for (int size : { 0x1000, 0x8000 })
+			{
+				auto compressed = std::make_shared<std::vector<std::uint8_t>>(makeSyntheticCompressedData(random, size, lz3 != 0));
+				auto output = std::make_shared<std::vector<std::uint8_t>>();
+				output->reserve(size);
+
+				std::string name = std::string(lz3 ? "decompressLZ3" : "decompressLZ2") + (size == 0x1000 ? "/4KB" : "/32KB");
+				benchmarks.push_back({ name, "bytes", (double)size, [=]
+				{
+					output->clear();
+					if (lz3) decompressLZ3(compressed->begin(), compressed->end(), std::back_inserter(*output));
+					else decompressLZ2(compressed->begin(), compressed->end(), std::back_inserter(*output));
+					consume(output->size());
+				} });
+			}
+		}
+
+		// Tile decoding:  a 32KB sheet at every bpp, with every combination of flips.
+		{
+			auto graphics = std::make_shared<std::vector<std::uint8_t>>(makeRandomBytes(random, 0x8000));
+			auto palette = std::make_shared<std::vector<std::uint32_t>>(makeRandomColors(random, 256));
+			auto output = std::make_shared<std::vector<std::uint32_t>>();
+
+			for (int bpp : { 2, 4, 8 })
+			{
+				for (int flip = 0; flip < 4; flip++)
+				{
+					bool flipX = (flip & 1) != 0, flipY = (flip & 2) != 0;
+					int pixels = 0x8000 * 8 / bpp;
+					std::string name = "indexedImageToBitmap/" + std::to_string(bpp) + "bpp" + (flipX ? "/flipX" : "") + (flipY ? "/flipY" : "");
+					benchmarks.push_back({ name, "items", (double)pixels, [=]
+					{
+						output->clear();
+						output->reserve(pixels);
+						indexedImageToBitmap(graphics->begin(), graphics->end(), palette->begin(), palette->end(), 0x10, bpp, 0, 0, -1, -1, flipX, flipY, 0, std::back_inserter(*output));
+						consume(output->size());
+					} });
+				}
+			}
+		}
+
+		// Palettes:  every level, with vanilla-style and custom palettes.
+		for (int custom = 0; custom < 2; custom++)
+		{
+			SyntheticROMOptions options;
+			options.customPalettePercent = custom ? 100 : 0;
+			auto rom = std::make_shared<std::vector<std::uint8_t>>(makeSyntheticROM(options));
+			auto output = std::make_shared<std::vector<std::uint32_t>>();
+			output->reserve(256);
+
+			benchmarks.push_back({ custom ? "getLevelPalette/custom" : "getLevelPalette/standard", "items", (double)internal::levelCount, [=]
+			{
+				for (int level = 0; level < internal::levelCount; level++)
+				{
+					output->clear();
+					getLevelPalette(rom->begin(), rom->end(), std::back_inserter(*output), level);
+					consume((*output)[level & 0xFF]);
+				}
+			} });
+		}
+
+		// Address mapping and ROM reads, for plain LoROM and SA-1.
+		for (int sa1 = 0; sa1 < 2; sa1++)
+		{
+			auto rom = std::make_shared<std::vector<std::uint8_t>>(makeRandomBytes(random, 0x100000));
+			(*rom)[0x7FD5] = sa1 ? 0x23 : 0x20;
+			(*rom)[0x7FD6] = sa1 ? 0x35 : 0x00;
+			auto addresses = std::make_shared<std::vector<int>>(makeAddresses(random, 4096, sa1 != 0));
+			std::string suffix = sa1 ? "/SA-1" : "/LoROM";
+
+			benchmarks.push_back({ "SFCToPC" + suffix, "items", (double)addresses->size(), [=]
+			{
+				std::uint64_t total = 0;
+				for (int address : *addresses) total += SFCToPC(rom->begin(), rom->end(), address);
+				consume(total);
+			} });
+
+			benchmarks.push_back({ "readWordSFC" + suffix, "items", (double)addresses->size(), [=]
+			{
+				std::uint64_t total = 0;
+				for (int address : *addresses) total += readWordSFC(rom->begin(), rom->end(), address);
+				consume(total);
+			} });
+		}
+
+		// Color insertion:  the same 64K colors through each way of writing them out.
+		{
+			const int colorCount = 0x10000;
+			auto colors = std::make_shared<std::vector<std::uint32_t>>(makeRandomColors(random, colorCount));
+			auto bytes = std::make_shared<std::vector<std::uint8_t>>();
+			auto words = std::make_shared<std::vector<std::uint32_t>>();
+			bytes->reserve(colorCount * 4);
+			words->reserve(colorCount);
+
+			benchmarks.push_back({ "ColorBackInserterIterator/RGBA/bytes", "items", (double)colorCount, [=]
+			{
+				bytes->clear();
+				std::copy(colors->begin(), colors->end(), ColorBackInserter(*bytes, ColorOrder::RGBA));
+				consume(bytes->size());
+			} });
+
+			benchmarks.push_back({ "ColorBackInserterIterator/RGBA/words", "items", (double)colorCount, [=]
+			{
+				words->clear();
+				std::copy(colors->begin(), colors->end(), ColorBackInserter(*words, ColorOrder::RGBA));
+				consume(words->size());
+			} });
+
+			benchmarks.push_back({ "ColorBackInserterIterator/ARGB/bytes", "items", (double)colorCount, [=]
+			{
+				bytes->clear();
+				std::copy(colors->begin(), colors->end(), ColorBackInserter(*bytes, ColorOrder::ARGB));
+				consume(bytes->size());
+			} });
+
+			benchmarks.push_back({ "StaticColorBackInserterIterator/RGBA/bytes", "items", (double)colorCount, [=]
+			{
+				bytes->clear();
+				std::copy(colors->begin(), colors->end(), ColorBackInserter<ColorOrder::RGBA>(*bytes));
+				consume(bytes->size());
+			} });
+
+			benchmarks.push_back({ "swizzleColors/RGBA", "items", (double)colorCount, [=]
+			{
+				bytes->resize(colorCount * 4);
+				swizzleColors(colors->data(), colors->size(), ColorOrder::RGBA, bytes->data());
+				consume((*bytes)[colorCount]);
+			} });
+		}
+
+		// Whole-ROM workloads, on the default synthetic ROM in both mappings.
+		for (int sa1 = 0; sa1 < 2; sa1++)
+		{
+			SyntheticROMOptions options;
+			options.sa1 = sa1 != 0;
+			auto rom = std::make_shared<std::vector<std::uint8_t>>(makeSyntheticROM(options));
+			auto index = std::make_shared<LevelIndex>(rom->begin(), rom->end());
+			std::string suffix = sa1 ? "/SA-1" : "/LoROM";
+
+			auto files = std::make_shared<std::vector<int>>();
+			for (int file = 0; file < 0x1000; file++)
+				if (file != 0x7F && romContainsGraphicsFile(rom->begin(), rom->end(), file)) files->push_back(file);
+
+			benchmarks.push_back({ "rom/checkROMValid" + suffix, "items", 1, [=]
+			{
+				consume(checkROMValid(rom->begin(), rom->end()));
+			} });
+
+			benchmarks.push_back({ "rom/LevelIndex" + suffix, "items", (double)internal::levelCount, [=]
+			{
+				LevelIndex levels(rom->begin(), rom->end());
+				consume(levels.getLayer1Pointer(0x105));
+			} });
+
+			benchmarks.push_back({ "rom/getAllLevelPalettes" + suffix, "items", (double)internal::levelCount, [=]
+			{
+				consume(getAllLevelPalettes(rom->begin(), rom->end(), *index).palettes.size());
+			} });
+
+			auto graphics = std::make_shared<std::vector<std::uint8_t>>();
+			benchmarks.push_back({ "rom/decompressGraphicsFile/all" + suffix, "items", (double)files->size(), [=]
+			{
+				for (int file : *files)
+				{
+					graphics->clear();
+					decompressGraphicsFile(rom->begin(), rom->end(), std::back_inserter(*graphics), file);
+					consume(graphics->size());
+				}
+			} });
+
+			auto vram = std::make_shared<std::vector<std::uint8_t>>(internal::levelVRAMSize);
+			benchmarks.push_back({ "rom/composeLevelVRAM/all" + suffix, "items", (double)internal::levelCount, [=]
+			{
+				for (int level = 0; level < internal::levelCount; level++)
+				{
+					composeLevelVRAM(rom->begin(), rom->end(), level, vram->begin(), 1);
+					consume((*vram)[level]);
+				}
+			} });
+		}
+
+		return benchmarks;
+	}
+
+
+	////////////////////////////////////////////////////////////
+	// Running and reporting
+	////////////////////////////////////////////////////////////
+
+	struct Settings
+	{
+		int samples;
+		int warmupMilliseconds;
+		int sampleMilliseconds;
+	};
+
+	double timeIterations(const Benchmark &benchmark, long long iterations)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (long long i = 0; i < iterations; i++)
+			benchmark.run();
+		return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	BenchmarkResult runBenchmark(const Benchmark &benchmark, const Settings &settings)
+	{
+		// Warm up the caches and branch predictors, and find out roughly how long one iteration takes while doing it.
+		long long iterations = 0;
+		double elapsed = 0;
+		while (elapsed < settings.warmupMilliseconds * 1e6 || iterations == 0)
+		{
+			elapsed += timeIterations(benchmark, 1);
+			iterations++;
+		}
+
+		BenchmarkResult result;
+		result.benchmark = &benchmark;
+		result.iterationsPerSample = std::max(1LL, (long long)(settings.sampleMilliseconds * 1e6 / (elapsed / iterations)));
+
+		for (int sample = 0; sample < settings.samples; sample++)
+			result.samples.push_back(timeIterations(benchmark, result.iterationsPerSample) / result.iterationsPerSample);
+
+		std::vector<double> sorted = result.samples;
+		std::sort(sorted.begin(), sorted.end());
+		std::size_t count = sorted.size();
+		result.min = sorted.front();
+		result.max = sorted.back();
+		result.median = (count % 2 == 1) ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) / 2;
+
+		double sum = 0;
+		for (double sample : sorted) sum += sample;
+		result.mean = sum / count;
+
+		double squares = 0;
+		for (double sample : sorted) squares += (sample - result.mean) * (sample - result.mean);
+		result.stddev = count > 1 ? std::sqrt(squares / (count - 1)) : 0;
+
+		return result;
+	}
+
+	// Units processed per second, based on the median sample.
+	double getThroughput(const BenchmarkResult &result)
+	{
+		return result.benchmark->workPerIteration / (result.median / 1e9);
+	}
+
+	std::string escapeJSON(const std::string &text)
+	{
+		std::string escaped;
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\') escaped += '\\';
+			escaped += c;
+		}
+		return escaped;
+	}
+
+	// swizzleColors picks its instructions at run time, and the compositor at compile time
+	std::string getSIMDLevel()
+	{
+		const char *swizzle[] = { "none", "ssse3", "avx2" };
+		const char *compositor[] = { "none", "sse2", "avx2" };
+		return std::string("swizzle ") + swizzle[(int)internal::getSwizzleInstructionSet()] + ", compositor " + compositor[(int)internal::getCompositorInstructionSet()];
+	}
+
+	const char *getCompiler()
+	{
+#if defined(_MSC_VER)
+		return "msvc";
+#elif defined(__clang__)
+		return "clang";
+#elif defined(__GNUC__)
+		return "gcc";
+#else
+		return "unknown";
+#endif
+	}
+
+	void writeJSON(std::FILE *file, const std::vector<BenchmarkResult> &results, const Settings &settings)
+	{
+		std::fprintf(file, "{\n");
+		std::fprintf(file, "  \"context\": {\"compiler\": \"%s\", \"simd\": \"%s\", \"samples\": %d, \"warmup_ms\": %d, \"sample_ms\": %d},\n", getCompiler(), getSIMDLevel().c_str(), settings.samples, settings.warmupMilliseconds, settings.sampleMilliseconds);
+		std::fprintf(file, "  \"benchmarks\": [\n");
+		for (std::size_t i = 0; i < results.size(); i++)
+		{
+			const BenchmarkResult &result = results[i];
+			std::fprintf(file, "    {\"name\": \"%s\", \"unit\": \"%s\", \"work_per_iteration\": %.0f, \"iterations_per_sample\": %lld, ", escapeJSON(result.benchmark->name).c_str(), result.benchmark->unit.c_str(), result.benchmark->workPerIteration, result.iterationsPerSample);
+			std::fprintf(file, "\"ns_per_iteration\": {\"min\": %.1f, \"median\": %.1f, \"mean\": %.1f, \"max\": %.1f, \"stddev\": %.1f}, ", result.min, result.median, result.mean, result.max, result.stddev);
+			std::fprintf(file, "\"%s_per_second\": %.0f, \"samples\": [", result.benchmark->unit.c_str(), getThroughput(result));
+			for (std::size_t sample = 0; sample < result.samples.size(); sample++)
+				std::fprintf(file, "%s%.1f", sample == 0 ? "" : ", ", result.samples[sample]);
+			std::fprintf(file, "]}%s\n", i + 1 < results.size() ? "," : "");
+		}
+		std::fprintf(file, "  ]\n}\n");
+	}
+
+	void printResult(const BenchmarkResult &result)
+	{
+		double throughput = getThroughput(result);
+		const char *unit = "/s";
+		if (result.benchmark->unit == "bytes")
+		{
+			throughput /= 1024 * 1024;
+			unit = "MB/s";
+		}
+		else if (throughput >= 1e6)
+		{
+			throughput /= 1e6;
+			unit = "M/s";
+		}
+		else if (throughput >= 1e3)
+		{
+			throughput /= 1e3;
+			unit = "K/s";
+		}
+
+		std::fprintf(stderr, "%-44s %12.1f ns %8.1f%% %10.1f %s\n", result.benchmark->name.c_str(), result.median, 100 * result.stddev / result.mean, throughput, unit);
+	}
+
+	void printUsage()
+	{
+		std::printf("Usage: worldlib-bench [--filter text] [--samples N] [--warmup-ms N] [--sample-ms N] [--json file] [--list]\n");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	Settings settings = { 15, 200, 50 };
+	std::string filter;
+	std::string jsonPath;
+	bool list = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			filter = argv[++i];
+		else if (std::strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+			settings.samples = std::max(1, std::atoi(argv[++i]));
+		else if (std::strcmp(argv[i], "--warmup-ms") == 0 && i + 1 < argc)
+			settings.warmupMilliseconds = std::max(0, std::atoi(argv[++i]));
+		else if (std::strcmp(argv[i], "--sample-ms") == 0 && i + 1 < argc)
+			settings.sampleMilliseconds = std::max(1, std::atoi(argv[++i]));
+		else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+			jsonPath = argv[++i];
+		else if (std::strcmp(argv[i], "--list") == 0)
+			list = true;
+		else
+		{
+			printUsage();
+			return 1;
+		}
+	}
+
+	try
+	{
+		std::vector<Benchmark> benchmarks = makeBenchmarks();
+		std::vector<BenchmarkResult> results;
+
+		if (!list)
+			std::fprintf(stderr, "%-44s %15s %9s %15s\n", "benchmark", "median", "stddev", "throughput");
+
+		for (const auto &benchmark : benchmarks)
+		{
+			if (filter.empty() == false && benchmark.name.find(filter) == std::string::npos) continue;
+			if (list)
+			{
+				std::printf("%s\n", benchmark.name.c_str());
+				continue;
+			}
+
+			results.push_back(runBenchmark(benchmark, settings));
+			printResult(results.back());
+		}
+		if (list) return 0;
+
+		std::FILE *file = jsonPath.empty() ? stdout : std::fopen(jsonPath.c_str(), "w");
+		if (file == nullptr)
+		{
+			std::fprintf(stderr, "Could not open %s for writing.\n", jsonPath.c_str());
+			return 1;
+		}
+		writeJSON(file, results, settings);
+		if (file != stdout) std::fclose(file);
+		return 0;
+	}
+	catch (std::exception &e)
+	{
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+}
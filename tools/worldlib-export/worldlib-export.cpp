@@ -0,0 +1,447 @@
+// worldlib-export:  dumps every graphics file, level palette and level graphics sheet in a ROM.
+//
+// Usage:  worldlib-export <rom> <output directory> [--threads N] [--compression store|fast|best]
+//
+// Writes:
+//	gfx/GFXxx.bin, gfx/GFXxx.png		Decompressed GFX00-31, and the same drawn as a grayscale sheet
+//	exgfx/ExGFXxxx.bin, exgfx/ExGFXxxx.png	The same for ExGFX80-FFF
+//	palettes/Levelxxx.pal, .png		Each level's palette (256 RGB triplets, with the BG color as color 0) and a swatch image of it
+//	levels/Levelxxx.png			Each level's VRAM (composeLevelVRAM) drawn with the level's own palette
+//
+// File names only depend on the ROM, so two runs over the same ROM always write the same files.
+// The work is spread over a work-stealing thread pool, and the time spent in each stage is reported at the end.
+
+#include <vector>
+#include <array>
+#include <deque>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#define WORLDLIB_IGNORE_DLL_FUNCTIONS
+#include "../../SFC.hpp"
+#include "../../WorldLib.hpp"
+
+using namespace worldlib;
+
+namespace
+{
+	////////////////////////////////////////////////////////////
+	// A thread pool where each thread has its own queue of tasks, and takes from the other threads' queues when its own runs out.
+	// Tasks are handed out round-robin up front, so threads that get stuck with slow tasks (big ExGFX files, levels with many files) have the rest of their queue taken over by threads that got fast ones.
+	// Every task has to be submitted before run is called, so a thread that finds every queue empty knows there's nothing left for it and can stop.
+	////////////////////////////////////////////////////////////
+	class WorkStealingPool
+	{
+	public:
+		explicit WorkStealingPool(int threadCount) : queues(threadCount), locks(threadCount), nextQueue(0)
+		{
+		}
+
+		void submit(std::function<void()> task)
+		{
+			int queue = nextQueue++ % (int)queues.size();
+			std::lock_guard<std::mutex> lock(locks[queue]);
+			queues[queue].push_back(std::move(task));
+		}
+
+		// Runs every submitted task, and returns once they're all done.
+		void run()
+		{
+			std::vector<std::thread> threads;
+			for (int i = 1; i < (int)queues.size(); i++)
+				threads.emplace_back([this, i] { work(i); });
+			work(0);
+			for (auto &t : threads)
+				t.join();
+		}
+
+	private:
+		bool takeTask(int self, std::function<void()> &task)
+		{
+			// Own tasks come off the back, stolen ones off the front, so a thread and a thief rarely want the same task.
+			for (int offset = 0; offset < (int)queues.size(); offset++)
+			{
+				int queue = (self + offset) % (int)queues.size();
+				std::lock_guard<std::mutex> lock(locks[queue]);
+				if (queues[queue].empty()) continue;
+
+				if (offset == 0)
+				{
+					task = std::move(queues[queue].back());
+					queues[queue].pop_back();
+				}
+				else
+				{
+					task = std::move(queues[queue].front());
+					queues[queue].pop_front();
+				}
+				return true;
+			}
+			return false;
+		}
+
+		void work(int self)
+		{
+			std::function<void()> task;
+			while (takeTask(self, task))
+				task();
+		}
+
+		std::vector<std::deque<std::function<void()>>> queues;
+		std::vector<std::mutex> locks;
+		std::atomic<int> nextQueue;
+	};
+
+	enum Stage
+	{
+		Decompress,
+		Render,
+		Encode,
+		Write,
+		StageCount
+	};
+
+	const char *stageNames[StageCount] = { "decompress", "render", "encode", "write" };
+
+	std::atomic<long long> stageTimes[StageCount];				// Nanoseconds, summed over every thread
+	std::atomic<long long> bytesWritten;
+	std::atomic<int> filesWritten;
+
+	std::mutex errorLock;
+	std::vector<std::string> errors;
+
+	// Times whatever's in its scope and adds it to a stage's total.
+	class StageTimer
+	{
+	public:
+		explicit StageTimer(Stage stage) : stage(stage), start(std::chrono::steady_clock::now())
+		{
+		}
+
+		~StageTimer()
+		{
+			stageTimes[stage] += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		}
+
+	private:
+		Stage stage;
+		std::chrono::steady_clock::time_point start;
+	};
+
+	void addError(const std::string &error)
+	{
+		std::lock_guard<std::mutex> lock(errorLock);
+		errors.push_back(error);
+	}
+
+	void makeDirectory(const std::string &path)
+	{
+#ifdef _WIN32
+		_mkdir(path.c_str());
+#else
+		mkdir(path.c_str(), 0777);
+#endif
+	}
+
+	std::string hexName(const char *prefix, int number, int digits, const char *extension)
+	{
+		char buffer[64];
+		std::sprintf(buffer, "%s%0*X%s", prefix, digits, number, extension);
+		return buffer;
+	}
+
+	void writeFile(const std::string &path, const std::vector<std::uint8_t> &data)
+	{
+		StageTimer timer(Write);
+		std::ofstream file(path, std::ios::out | std::ios::binary);
+		if (!file)
+			throw std::runtime_error("Could not open " + path + " for writing.");
+		file.write(reinterpret_cast<const char *>(data.data()), data.size());
+		if (!file)
+			throw std::runtime_error("Could not write " + path + ".");
+
+		bytesWritten += data.size();
+		filesWritten++;
+	}
+
+	// Turns 4bpp tiles into one palette index per pixel, 16 tiles across.
+	std::vector<std::uint8_t> tilesToIndices(const std::vector<std::uint8_t> &tiles, int paletteRowForTile(int), int &width, int &height)
+	{
+		// indexedImageToBitmap only outputs colors, so give it a palette where every color is its own index.
+		std::vector<std::uint32_t> identity(256);
+		for (int i = 0; i < 256; i++) identity[i] = 0xFF000000 | i;
+
+		int tileCount = (int)tiles.size() / 32;
+		width = 16 * 8;
+		height = (tileCount + 15) / 16 * 8;
+		std::vector<std::uint8_t> indices(width * height, 0);
+
+		std::vector<std::uint32_t> tilePixels;
+		for (int tile = 0; tile < tileCount; tile++)
+		{
+			tilePixels.clear();
+			indexedImageToBitmap(tiles.begin() + tile * 32, tiles.begin() + tile * 32 + 32, identity.begin(), identity.end(), 4, false, false, paletteRowForTile(tile), std::back_inserter(tilePixels));
+
+			int left = (tile % 16) * 8, top = (tile / 16) * 8;
+			for (int y = 0; y < 8; y++)
+				for (int x = 0; x < 8; x++)
+					indices[(top + y) * width + left + x] = static_cast<std::uint8_t>(tilePixels[y * 8 + x]);
+		}
+		return indices;
+	}
+
+	int paletteRow0(int)
+	{
+		return 0;
+	}
+
+	// VRAM sheets use the layer 1/2 palette (row 2) for the FG/BG/AN2 slots and the yellow sprite palette (row A) for the SP slots.
+	int levelSheetPaletteRow(int tile)
+	{
+		int slot = tile / (0x1000 / 32);
+		return (slot >= (int)GFXSlots::SP1 && slot <= (int)GFXSlots::SP4) ? 0x0A : 0x02;
+	}
+
+	template <typename iteratorType>
+	void exportGraphicsFile(iteratorType romStart, iteratorType romEnd, int file, const std::string &directory, PNGCompression compression)
+	{
+		std::vector<std::uint8_t> data;
+		{
+			StageTimer timer(Decompress);
+			decompressGraphicsFile(romStart, romEnd, std::back_inserter(data), file);
+		}
+
+		std::string base = directory + (file < 0x80 ? hexName("/gfx/GFX", file, 2, "") : hexName("/exgfx/ExGFX", file, 2, ""));
+		writeFile(base + ".bin", data);
+
+		int width, height;
+		std::vector<std::uint8_t> indices;
+		{
+			StageTimer timer(Render);
+			std::vector<std::uint8_t> tiles = data;
+			if (tiles.size() == 0xC00)							// 3bpp, like composeLevelVRAM treats it
+			{
+				tiles.resize(0x1000);
+				internal::expand3bppTo4bpp(tiles.begin(), 0x80);
+			}
+			indices = tilesToIndices(tiles, paletteRow0, width, height);
+		}
+		if (height == 0) return;
+
+		std::vector<std::uint32_t> grayscale(16);
+		for (int i = 0; i < 16; i++) grayscale[i] = 0xFF000000 | (i * 0x111111);
+
+		std::vector<std::uint8_t> png;
+		{
+			StageTimer timer(Encode);
+			writeIndexedPNG(indices.begin(), indices.end(), width, height, grayscale.begin(), grayscale.end(), std::back_inserter(png), compression);
+		}
+		writeFile(base + ".png", png);
+	}
+
+	void exportPalette(const std::array<std::uint16_t, 256> &palette, std::uint16_t backgroundColor, int level, const std::string &directory, PNGCompression compression)
+	{
+		std::vector<std::uint32_t> colors;
+		{
+			StageTimer timer(Render);
+			SFCToARGB(palette.begin(), palette.end(), std::back_inserter(colors));
+			colors[0] = SFCToARGB(backgroundColor);
+		}
+
+		std::vector<std::uint8_t> pal;
+		for (auto c : colors)
+		{
+			pal.push_back(static_cast<std::uint8_t>(c >> 16));
+			pal.push_back(static_cast<std::uint8_t>(c >> 8));
+			pal.push_back(static_cast<std::uint8_t>(c));
+		}
+		std::string base = directory + hexName("/palettes/Level", level, 3, "");
+		writeFile(base + ".pal", pal);
+
+		// 16x16 swatches of 8x8 pixels each
+		std::vector<std::uint8_t> indices(128 * 128);
+		for (int y = 0; y < 128; y++)
+			for (int x = 0; x < 128; x++)
+				indices[y * 128 + x] = static_cast<std::uint8_t>((y / 8) * 16 + x / 8);
+
+		std::vector<std::uint8_t> png;
+		{
+			StageTimer timer(Encode);
+			writeIndexedPNG(indices.begin(), indices.end(), 128, 128, colors.begin(), colors.end(), std::back_inserter(png), compression);
+		}
+		writeFile(base + ".png", png);
+	}
+
+	template <typename iteratorType>
+	void exportLevelSheet(iteratorType romStart, iteratorType romEnd, const std::array<std::uint16_t, 256> &palette, std::uint16_t backgroundColor, int level, const std::string &directory, PNGCompression compression)
+	{
+		std::vector<std::uint8_t> vram(0xB000);
+		{
+			StageTimer timer(Decompress);
+			composeLevelVRAM(romStart, romEnd, level, vram.begin(), 1);		// The pool already keeps every thread busy.
+		}
+
+		int width, height;
+		std::vector<std::uint8_t> indices;
+		std::vector<std::uint32_t> colors;
+		{
+			StageTimer timer(Render);
+			indices = tilesToIndices(vram, levelSheetPaletteRow, width, height);
+			SFCToARGB(palette.begin(), palette.end(), std::back_inserter(colors));
+			colors[0] = SFCToARGB(backgroundColor);
+		}
+
+		std::vector<std::uint8_t> png;
+		{
+			StageTimer timer(Encode);
+			writeIndexedPNG(indices.begin(), indices.end(), width, height, colors.begin(), colors.end(), std::back_inserter(png), compression);
+		}
+		writeFile(directory + hexName("/levels/Level", level, 3, ".png"), png);
+	}
+
+	void printUsage()
+	{
+		std::printf("Usage: worldlib-export <rom> <output directory> [--threads N] [--compression store|fast|best]\n");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 3)
+	{
+		printUsage();
+		return 1;
+	}
+
+	std::string romPath = argv[1];
+	std::string directory = argv[2];
+	int threadCount = (int)std::thread::hardware_concurrency();
+	PNGCompression compression = PNGCompression::Fast;
+
+	for (int i = 3; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+		{
+			threadCount = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--compression") == 0 && i + 1 < argc)
+		{
+			std::string level = argv[++i];
+			if (level == "store") compression = PNGCompression::Store;
+			else if (level == "fast") compression = PNGCompression::Fast;
+			else if (level == "best") compression = PNGCompression::Best;
+			else
+			{
+				printUsage();
+				return 1;
+			}
+		}
+		else
+		{
+			printUsage();
+			return 1;
+		}
+	}
+	if (threadCount <= 0) threadCount = 1;
+
+	auto wallStart = std::chrono::steady_clock::now();
+
+	std::vector<unsigned char> rom;
+	std::ifstream in(romPath, std::ios::in | std::ios::binary);
+	if (in)	rom = std::vector<unsigned char>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	else
+	{
+		std::fprintf(stderr, "Could not open %s.\n", romPath.c_str());
+		return 1;
+	}
+
+	try
+	{
+		auto romStart = getROMStart(rom.begin(), rom.end());
+		auto romEnd = rom.end();
+		if (checkROMValid(romStart, romEnd) == false)
+		{
+			std::fprintf(stderr, "%s isn't a Lunar Magic-edited SMW ROM.\n", romPath.c_str());
+			return 1;
+		}
+
+		makeDirectory(directory);
+		makeDirectory(directory + "/gfx");
+		makeDirectory(directory + "/exgfx");
+		makeDirectory(directory + "/palettes");
+		makeDirectory(directory + "/levels");
+
+		auto indexStart = std::chrono::steady_clock::now();
+		LevelIndex index(romStart, romEnd);
+		LevelPaletteTable palettes = getAllLevelPalettes(romStart, romEnd, index);
+		auto indexTime = std::chrono::steady_clock::now() - indexStart;
+
+		WorkStealingPool pool(threadCount);
+
+		for (int file = 0; file < 0x1000; file++)
+		{
+			if (file == 0x7F || romContainsGraphicsFile(romStart, romEnd, file) == false) continue;
+			pool.submit([=]
+			{
+				try { exportGraphicsFile(romStart, romEnd, file, directory, compression); }
+				catch (std::exception &e) { addError(hexName(file < 0x80 ? "GFX " : "ExGFX ", file, 2, ": ") + e.what()); }
+			});
+		}
+
+		for (int level = 0; level < index.getLevelCount(); level++)
+		{
+			if (index.isLevelValid(level) == false || palettes.levelPaletteIndices[level] < 0) continue;
+			const auto &palette = palettes.palettes[palettes.levelPaletteIndices[level]];
+			std::uint16_t backgroundColor = palettes.levelBackgroundColors[level];
+
+			pool.submit([=, &palette]
+			{
+				try { exportPalette(palette, backgroundColor, level, directory, compression); }
+				catch (std::exception &e) { addError(hexName("Level ", level, 3, " palette: ") + e.what()); }
+			});
+			pool.submit([=, &palette]
+			{
+				try { exportLevelSheet(romStart, romEnd, palette, backgroundColor, level, directory, compression); }
+				catch (std::exception &e) { addError(hexName("Level ", level, 3, " graphics: ") + e.what()); }
+			});
+		}
+
+		pool.run();
+
+		auto wallTime = std::chrono::steady_clock::now() - wallStart;
+		auto milliseconds = [](long long nanoseconds) { return nanoseconds / 1000000.0; };
+
+		std::printf("Wrote %d files (%lld bytes) with %d threads in %.1f ms.\n", (int)filesWritten, (long long)bytesWritten, threadCount, milliseconds(std::chrono::duration_cast<std::chrono::nanoseconds>(wallTime).count()));
+		std::printf("  %-12s %10.1f ms\n", "index", milliseconds(std::chrono::duration_cast<std::chrono::nanoseconds>(indexTime).count()));
+		for (int stage = 0; stage < StageCount; stage++)
+			std::printf("  %-12s %10.1f ms (all threads)\n", stageNames[stage], milliseconds(stageTimes[stage]));
+
+		std::sort(errors.begin(), errors.end());
+		for (auto &error : errors)
+			std::fprintf(stderr, "%s\n", error.c_str());
+		return errors.empty() ? 0 : 2;
+	}
+	catch (std::exception &e)
+	{
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+}